@@ -4,9 +4,11 @@
 
 #include <iostream>
 #include <cassert>
+#include <unordered_map>
 #include "bdd.hpp"
 #include "../util/util.hpp"
 #include "../util/stats.hpp"
+#include "../util/hash.hpp"
 
 #ifdef USE_GMP
 #include <gmpxx.h>
@@ -142,10 +144,28 @@ void BDD::print(bool use_global_id /* = false */, bool print_tag /* = false */)
 
 
 
+// Frozen representation
+
+void BDD::freeze()
+{
+	delete frozen;
+	frozen = new FrozenBDD(this);
+}
+
+
+void BDD::unfreeze()
+{
+	delete frozen;
+	frozen = NULL;
+}
+
+
+
 // Node manipulation functions
 
 Node* BDD::create_node(int layer)
 {
+	unfreeze();
 	Node* node = new Node(NULL, -1);
 	node->layer = layer;
 	node->id = layers[layer].size();
@@ -169,6 +189,8 @@ Node* BDD::duplicate_node(Node* node)
 
 void BDD::remove_node_no_arcs(Node* node)
 {
+	unfreeze();
+
 	// Remove node from BDD, updating ids
 	int layer = node->layer;
 	int size = layers[layer].size();
@@ -301,10 +323,109 @@ void BDD::remove_pathless_nodes()
 }
 
 
+/** Hash of the pair of children of a node, for the unique table in BDD::reduce */
+struct HashNodeChildren {
+	size_t operator()(const pair<Node*, Node*>& children) const
+	{
+		return hash_key((uintptr_t) children.first, (uintptr_t) children.second);
+	}
+};
+
+
+int BDD::reduce(DDReductionRule rule)
+{
+	unfreeze();
+
+	int nremoved = 0;
+	int root_layer = get_root_layer();
+	int terminal_layer = get_terminal_layer();
+
+	unordered_map<pair<Node*, Node*>, Node*, HashNodeChildren> unique_table;
+	vector<Node*> removed_nodes;
+	vector<Node*> kept_nodes;
+	vector<Node*> touched_children;
+
+	// Children are final when a layer is processed, so a single bottom-up pass suffices
+	for (int layer = terminal_layer - 1; layer >= root_layer; --layer) {
+		unique_table.clear();
+		removed_nodes.clear();
+		kept_nodes.clear();
+
+		for (Node* node : layers[layer]) {
+			bool has_parents = !node->zero_ancestors.empty() || !node->one_ancestors.empty();
+
+			// Redundant node: redirect parents to its only child
+			Node* skip_child = NULL;
+			if (rule == REDUCE_ZDD && node->one_arc == NULL) {
+				skip_child = node->zero_arc;
+			} else if (rule == REDUCE_BDD && node->zero_arc == node->one_arc) {
+				skip_child = node->zero_arc;
+			}
+			if (skip_child != NULL && has_parents && !node->relaxed_node) {
+				skip_child->pull_parents(node);
+				removed_nodes.push_back(node);
+				continue;
+			}
+
+			// Node with the same children as a previous node: merge into that node
+			pair<Node*, Node*> children(node->zero_arc, node->one_arc);
+			pair<unordered_map<pair<Node*, Node*>, Node*, HashNodeChildren>::iterator, bool> res =
+			    unique_table.insert(make_pair(children, node));
+			if (!res.second) {
+				Node* existing = res.first->second;
+				existing->pull_parents(node);
+				existing->update_optimal_path(node);
+				existing->relaxed_node = existing->relaxed_node || node->relaxed_node;
+				removed_nodes.push_back(node);
+				continue;
+			}
+
+			node->id = kept_nodes.size();
+			kept_nodes.push_back(node);
+		}
+
+		if (removed_nodes.empty()) {
+			continue;
+		}
+
+		// Detach removed nodes from their children in a single pass over each child's ancestors
+		touched_children.clear();
+		for (Node* node : removed_nodes) {
+			node->id = DD_NODE_ID_OPEN;
+			if (node->zero_arc != NULL) {
+				touched_children.push_back(node->zero_arc);
+			}
+			if (node->one_arc != NULL) {
+				touched_children.push_back(node->one_arc);
+			}
+		}
+		sort(touched_children.begin(), touched_children.end());
+		touched_children.erase(unique(touched_children.begin(), touched_children.end()), touched_children.end());
+		for (Node* child : touched_children) {
+			for (vector<Node*>* ancestors : { &child->zero_ancestors, &child->one_ancestors }) {
+				ancestors->erase(remove_if(ancestors->begin(), ancestors->end(), [](Node* ancestor) {
+					return ancestor->id == DD_NODE_ID_OPEN;
+				}), ancestors->end());
+			}
+		}
+
+		for (Node* node : removed_nodes) {
+			node->zero_arc = NULL;
+			node->one_arc = NULL;
+			delete node;
+		}
+		nremoved += removed_nodes.size();
+		layers[layer].swap(kept_nodes);
+	}
+
+	return nremoved;
+}
+
+
 
 // Computation of properties
 
-double BDD::get_optimal_path(vector<double> coeffs_layer, vector<int>& optimal_path, bool maximize,
+double BDD::get_optimal_path(const vector<double>& coeffs_layer, vector<int>& optimal_path, bool maximize,
                             bool ignore_relaxed_nodes /* = false */)
 {
 	vector<double> zero_coeffs(coeffs_layer.size(), 0);
@@ -313,7 +434,7 @@ double BDD::get_optimal_path(vector<double> coeffs_layer, vector<int>& optimal_p
 }
 
 
-double BDD::get_optimal_sol(vector<double> coeffs_var, vector<int>& optimal_sol, bool maximize,
+double BDD::get_optimal_sol(const vector<double>& coeffs_var, vector<int>& optimal_sol, bool maximize,
                            bool ignore_relaxed_nodes /* = false */)
 {
 	vector<double> zero_coeffs(coeffs_var.size(), 0);
@@ -340,9 +461,16 @@ double BDD::get_optimal_sol(vector<double> coeffs_var, vector<int>& optimal_sol,
 }
 
 
-double BDD::get_optimal_path_zero_one_coeffs(vector<double> zero_coeffs, vector<double> one_coeffs,
+double BDD::get_optimal_path_zero_one_coeffs(const vector<double>& zero_coeffs, const vector<double>& one_coeffs,
         vector<int>& optimal_path, bool maximize, bool ignore_relaxed_nodes /* = false */)
 {
+	if (frozen != NULL) {
+		double optimal_value = frozen->get_optimal_path_zero_one_coeffs(zero_coeffs, one_coeffs, optimal_path, maximize,
+		                       ignore_relaxed_nodes);
+		assert(optimal_path.empty() || DBL_EQ(compute_path_value(zero_coeffs, one_coeffs, optimal_path), optimal_value));
+		return optimal_value;
+	}
+
 	int bdd_size = layers.size();
 
 	assert(layers.size() > 0);
@@ -430,7 +558,7 @@ double BDD::get_optimal_path_zero_one_coeffs(vector<double> zero_coeffs, vector<
 }
 
 
-double BDD::compute_path_value(vector<double> zero_coeffs, vector<double> one_coeffs, vector<int>& path)
+double BDD::compute_path_value(const vector<double>& zero_coeffs, const vector<double>& one_coeffs, vector<int>& path)
 {
 	double value = 0;
 	int bdd_size = layers.size();
@@ -458,6 +586,11 @@ struct CenterData {
 /** Compute the center of a BDD */
 void BDD::get_center(vector<double>& center)
 {
+	if (frozen != NULL) {
+		frozen->get_center(center);
+		return;
+	}
+
 	CenterData* cd;
 	CenterData* cd2;
 	int bdd_size = layers.size();
@@ -8,6 +8,7 @@
 #include <map>
 #include <vector>
 #include "bdd_node.hpp"
+#include "frozen_bdd.hpp"
 #include "../util/util.hpp"
 #include "../problem/state.hpp"
 
@@ -16,6 +17,14 @@ using namespace std;
 #define DD_NODE_ID_OPEN -1
 
 
+/** Reduction rules applied by BDD::reduce in addition to merging nodes with the same children */
+enum DDReductionRule {
+	REDUCE_MERGE_ONLY,   /**< only merge nodes of the same layer with the same children */
+	REDUCE_ZDD,          /**< also remove nodes without a 1-arc; the resulting long arcs skip variables set to zero */
+	REDUCE_BDD           /**< also remove nodes whose arcs go to the same child; the resulting long arcs skip free variables */
+};
+
+
 /** Decision diagram structure */
 class BDD
 {
@@ -27,6 +36,7 @@ public:
 
 	double bound;                       /**< bound obtained at construction */
 	bool constructed;                   /**< if false, BDD is in the middle of being constructed */
+	FrozenBDD* frozen;                  /**< read-only snapshot used by path computations; NULL if not frozen */
 
 
 	int nvars()
@@ -34,10 +44,11 @@ public:
 		return layers.size() - 1; // Number of vars, or equivalently number of layers minus one
 	}
 
-	BDD() : constructed(false) {}
+	BDD() : constructed(false), frozen(NULL) {}
 
 	~BDD()
 	{
+		delete frozen;
 		for (vector< vector<Node*> >::iterator itl = layers.begin(); itl != layers.end(); ++itl) {
 			for (vector<Node*>::iterator it = (*itl).begin(); it != (*itl).end(); ++it) {
 				delete *it;
@@ -73,6 +84,18 @@ public:
 	void print(bool use_global_id = false, bool print_tag = false);
 
 
+	// Frozen representation
+
+	/**
+	 * Build a read-only snapshot of the BDD that speeds up path computations. Done after construction; any node
+	 * manipulation function below drops the snapshot.
+	 */
+	void freeze();
+
+	/** Drop the read-only snapshot, if any */
+	void unfreeze();
+
+
 	// Node manipulation functions
 
 	/** Create a featureless node (without State, longest_path, etc.) and add it to BDD */
@@ -99,6 +122,15 @@ public:
 	/** Remove all nodes that are not in a path from root to terminal */
 	void remove_pathless_nodes();
 
+	/**
+	 * Reduce the BDD bottom-up: nodes of a layer with the same children are merged and, depending on the rule, redundant
+	 * nodes are removed by redirecting their parents to their child, creating long arcs. The paths of the BDD (under the
+	 * semantics of long arcs of the rule) and its bound are preserved. Long arcs elsewhere in the code skip variables set
+	 * to zero, so REDUCE_BDD is only meant for diagrams that are not used by cuts or path computations. Relaxed nodes are
+	 * never removed, and a node merged with a relaxed node becomes relaxed. Return the number of nodes removed.
+	 */
+	int reduce(DDReductionRule rule);
+
 
 	// Computation of properties
 
@@ -107,7 +139,7 @@ public:
 	 * The difference between this and get_optimal_sol is that everything is in the layer space rather than
 	 * the variable space, including weights and the output solution. Returns total weight.
 	 */
-	double get_optimal_path(vector<double> coeffs_layer, vector<int>& optimal_path, bool maximize,
+	double get_optimal_path(const vector<double>& coeffs_layer, vector<int>& optimal_path, bool maximize,
 	                            bool ignore_relaxed_nodes = false);
 
 	/**
@@ -115,7 +147,7 @@ public:
 	 * The difference between this and get_optimal_path is that everything is in the variable space rather than
 	 * the layer space, including weights and the output solution. Returns total weight.
 	 */
-	double get_optimal_sol(vector<double> coeffs_var, vector<int>& optimal_sol, bool maximize,
+	double get_optimal_sol(const vector<double>& coeffs_var, vector<int>& optimal_sol, bool maximize,
 	                           bool ignore_relaxed_nodes = false);
 
 	/**
@@ -123,7 +155,7 @@ public:
 	 * zero_coeffs for 0-arcs and one_coeffs for 1-arcs. Returns total weight.
 	 * Weights must be in terms of layers, not variables.
 	 */
-	double get_optimal_path_zero_one_coeffs(vector<double> zero_coeffs, vector<double> one_coeffs,
+	double get_optimal_path_zero_one_coeffs(const vector<double>& zero_coeffs, const vector<double>& one_coeffs,
 	        vector<int>& optimal_path, bool maximize, bool ignore_relaxed_nodes = false);
 
 	/** Compute the center of a BDD */
@@ -159,7 +191,7 @@ private:
 	void remove_node_no_arcs(Node* node);
 
 	/** Compute value of a path */
-	double compute_path_value(vector<double> zero_coeffs, vector<double> one_coeffs, vector<int>& path);
+	double compute_path_value(const vector<double>& zero_coeffs, const vector<double>& one_coeffs, vector<int>& path);
 };
 
 
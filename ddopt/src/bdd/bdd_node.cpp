@@ -31,9 +31,15 @@ void Node::pull_parents(Node* node)
 
 
 void Node::update_optimal_path(Node* node)
+{
+	update_optimal_path(node->longest_path);
+}
+
+
+void Node::update_optimal_path(double path)
 {
 	// Assume we always maximize
-	longest_path = MAX(longest_path, node->longest_path);
+	longest_path = MAX(longest_path, path);
 }
 
 
@@ -8,6 +8,7 @@
 #include <vector>
 #include <boost/any.hpp>
 #include "../problem/state.hpp"
+#include "../util/slab.hpp"
 
 using namespace std;
 
@@ -76,6 +77,17 @@ public:
 
 	~Node();
 
+	/** Nodes are created and deleted in large numbers; allocate them from slabs */
+	static void* operator new(size_t size)
+	{
+		return slab_allocate(size);
+	}
+
+	static void operator delete(void* ptr, size_t size)
+	{
+		slab_deallocate(ptr, size);
+	}
+
 
 	// General functions
 
@@ -85,6 +97,9 @@ public:
 	/** Update the optimal path value with the maximum value between this and another node */
 	void update_optimal_path(Node* node);
 
+	/** Update the optimal path value with the maximum value between this and the value of a path to this node */
+	void update_optimal_path(double path);
+
 	/**
 	 * Merges this node with the given node, including merging the state and taking its parents.
 	 * The given node becomes isolated (assuming no children) and ready for deletion.
@@ -111,6 +111,60 @@ void bdd_pass(BDD* bdd, BDDPassFunc* top_down, BDDPassFunc* bottom_up)
 }
 
 
+void bdd_pass(const FrozenBDD* fbdd, BDDPassFunc* top_down, BDDPassFunc* bottom_up, vector<BDDPassValues>& values)
+{
+	if (top_down == NULL && bottom_up == NULL) {
+		cout << "Warning: Top-down/bottom-up pass attempted without required functions" << endl;
+		return; // Nothing needs to be done
+	}
+
+	int nnodes = fbdd->nnodes;
+
+	// Initialize values
+	values.resize(nnodes);
+	for (int i = 0; i < nnodes; ++i) {
+		if (top_down != NULL) {
+			values[i].top_down_val = top_down->init_val();
+		}
+		if (bottom_up != NULL) {
+			values[i].bottom_up_val = bottom_up->init_val();
+		}
+	}
+
+	// Top-down pass
+	if (top_down != NULL) {
+		values[fbdd->root].top_down_val = top_down->start_val();
+
+		for (int i = 0; i < nnodes; ++i) {
+			int layer = fbdd->node_layer[i];
+			for (int val = 0; val <= 1; ++val) {
+				int target = fbdd->child(i, val);
+				if (target != FROZEN_NO_NODE) {
+					values[target].top_down_val = top_down->apply(layer, fbdd->layer_to_var[layer], val,
+					                              values[i].top_down_val, values[target].top_down_val, fbdd->nodes[i], fbdd->nodes[target]);
+				}
+			}
+		}
+	}
+
+	// Bottom-up pass
+	if (bottom_up != NULL) {
+		values[fbdd->terminal].bottom_up_val = bottom_up->start_val();
+
+		for (int i = nnodes - 1; i >= 0; --i) {
+			int layer = fbdd->node_layer[i];
+			for (int val = 0; val <= 1; ++val) {
+				int source = fbdd->child(i, val);
+				if (source != FROZEN_NO_NODE) {
+					values[i].bottom_up_val = bottom_up->apply(layer, fbdd->layer_to_var[layer], val,
+					                          values[source].bottom_up_val, values[i].bottom_up_val, fbdd->nodes[source], fbdd->nodes[i]);
+				}
+			}
+		}
+	}
+}
+
+
 void bdd_pass_clean_up(BDD* bdd)
 {
 	int bdd_size = bdd->layers.size();
@@ -93,6 +93,12 @@ struct MinPassValMerger : Merger {
  */
 void bdd_pass(BDD* bdd, BDDPassFunc* top_down, BDDPassFunc* bottom_up);
 
+/**
+ * Same as bdd_pass, over a frozen BDD. Values are stored in values, indexed by node index, instead of in the nodes, so
+ * no clean-up is needed.
+ */
+void bdd_pass(const FrozenBDD* fbdd, BDDPassFunc* top_down, BDDPassFunc* bottom_up, vector<BDDPassValues>& values);
+
 /**
  * Deletes the values for top-down/bottom-up pass, assuming DD is fully constructed. Must always be called
  * after done with values.
@@ -0,0 +1,196 @@
+/**
+ * Compact read-only representation of a constructed decision diagram
+ */
+
+#include <iostream>
+#include <cassert>
+#include <limits>
+#include "frozen_bdd.hpp"
+#include "bdd.hpp"
+#include "../util/util.hpp"
+#include "../util/stats.hpp"
+
+#ifdef USE_GMP
+#include <gmpxx.h>
+#endif
+
+
+FrozenBDD::FrozenBDD(BDD* bdd)
+{
+	nlayers = bdd->layers.size();
+	layer_to_var = bdd->layer_to_var;
+
+	// Node indices
+	layer_offset.resize(nlayers + 1);
+	layer_offset[0] = 0;
+	for (int layer = 0; layer < nlayers; ++layer) {
+		layer_offset[layer + 1] = layer_offset[layer] + bdd->layers[layer].size();
+	}
+	nnodes = layer_offset[nlayers];
+	assert(nnodes < (1 << 30)); // parent arcs are encoded as 2 * parent + arc value in 32 bits
+
+	root = index(bdd->get_root_layer(), 0);
+	terminal = index(nlayers - 1, 0);
+
+	// Children and relaxed nodes
+	nodes.resize(nnodes);
+	node_layer.resize(nnodes);
+	zero_child.resize(nnodes);
+	one_child.resize(nnodes);
+	relaxed_bits.assign((nnodes + 63) / 64, 0);
+	vector<int32_t> nparents(nnodes, 0);
+	for (int layer = 0; layer < nlayers; ++layer) {
+		int size = bdd->layers[layer].size();
+		for (int k = 0; k < size; ++k) {
+			Node* node = bdd->layers[layer][k];
+			int i = index(layer, k);
+			assert(node->layer == layer && node->id == k);
+			nodes[i] = node;
+			node_layer[i] = layer;
+			zero_child[i] = (node->zero_arc != NULL) ? index(node->zero_arc->layer, node->zero_arc->id) : FROZEN_NO_NODE;
+			one_child[i] = (node->one_arc != NULL) ? index(node->one_arc->layer, node->one_arc->id) : FROZEN_NO_NODE;
+			if (zero_child[i] != FROZEN_NO_NODE) {
+				nparents[zero_child[i]]++;
+			}
+			if (one_child[i] != FROZEN_NO_NODE) {
+				nparents[one_child[i]]++;
+			}
+			if (node->relaxed_node) {
+				relaxed_bits[i >> 6] |= (uint64_t) 1 << (i & 63);
+			}
+		}
+	}
+
+	// Parents; since nodes are visited in increasing order, parent arcs of each node end up sorted
+	parent_offset.resize(nnodes + 1);
+	parent_offset[0] = 0;
+	for (int i = 0; i < nnodes; ++i) {
+		parent_offset[i + 1] = parent_offset[i] + nparents[i];
+	}
+	parent_arcs.resize(parent_offset[nnodes]);
+	vector<int32_t> next_pos(parent_offset.begin(), parent_offset.end() - 1);
+	for (int i = 0; i < nnodes; ++i) {
+		if (zero_child[i] != FROZEN_NO_NODE) {
+			parent_arcs[next_pos[zero_child[i]]++] = 2 * i;
+		}
+		if (one_child[i] != FROZEN_NO_NODE) {
+			parent_arcs[next_pos[one_child[i]]++] = 2 * i + 1;
+		}
+	}
+}
+
+
+double FrozenBDD::get_optimal_path_zero_one_coeffs(const vector<double>& zero_coeffs, const vector<double>& one_coeffs,
+        vector<int>& optimal_path, bool maximize, bool ignore_relaxed_nodes /* = false */) const
+{
+	assert((int) zero_coeffs.size() == nlayers - 1);
+	assert((int) one_coeffs.size() == nlayers - 1);
+
+	double worst = maximize ? -numeric_limits<double>::infinity() : numeric_limits<double>::infinity();
+	vector<double> value(nnodes, worst);
+	vector<int32_t> best_arc(nnodes, FROZEN_NO_NODE); // encoded as in parent_arcs
+	value[root] = 0;
+
+	// Pull values from parents in increasing order of (parent, arc value); this breaks ties in the same way as pushing
+	// values from parents to children in BDD::get_optimal_path_zero_one_coeffs
+	for (int i = root + 1; i < nnodes; ++i) {
+		double best = worst;
+		int32_t best_parent_arc = FROZEN_NO_NODE;
+		for (int a = parent_offset[i]; a < parent_offset[i + 1]; ++a) {
+			int32_t parent_arc = parent_arcs[a];
+			int parent = parent_arc >> 1;
+			if (ignore_relaxed_nodes && is_relaxed(parent)) {
+				continue;
+			}
+			const vector<double>& coeffs = (parent_arc & 1) ? one_coeffs : zero_coeffs;
+			double val = value[parent] + coeffs[node_layer[parent]];
+			if ((maximize && val > best) || (!maximize && val < best)) {
+				best = val;
+				best_parent_arc = parent_arc;
+			}
+		}
+		value[i] = best;
+		best_arc[i] = best_parent_arc;
+	}
+
+	if (best_arc[terminal] == FROZEN_NO_NODE) {
+		// Terminal node was unreachable due to pruning + skipping relaxed nodes
+		optimal_path.resize(0);
+		return worst;
+	}
+
+	// Extract optimal path; layers skipped by long arcs are set to zero
+	optimal_path.assign(nlayers - 1, 0);
+	int node = terminal;
+	while (best_arc[node] != FROZEN_NO_NODE) {
+		int parent = best_arc[node] >> 1;
+		optimal_path[node_layer[parent]] = best_arc[node] & 1;
+		node = parent;
+	}
+	assert(node == root);
+
+	return value[terminal];
+}
+
+
+#ifdef USE_GMP // Computing the center of a BDD requires arbitrary precision integers due to handling of very large values
+
+void FrozenBDD::get_center(vector<double>& center) const
+{
+	Stats stats;
+	stats.register_name("time-center");
+	stats.start_timer(0);
+
+	// Number of paths from root to each node and from each node to terminal
+	vector<mpz_class> top_down_val(nnodes, 0);
+	vector<mpz_class> bottom_up_val(nnodes, 0);
+	top_down_val[root] = 1;
+	bottom_up_val[terminal] = 1;
+
+	for (int i = 0; i < nnodes; ++i) {
+		if (zero_child[i] != FROZEN_NO_NODE) {
+			top_down_val[zero_child[i]] += top_down_val[i];
+		}
+		if (one_child[i] != FROZEN_NO_NODE) {
+			top_down_val[one_child[i]] += top_down_val[i];
+		}
+	}
+	for (int i = nnodes - 1; i >= 0; --i) {
+		if (zero_child[i] != FROZEN_NO_NODE) {
+			bottom_up_val[i] += bottom_up_val[zero_child[i]];
+		}
+		if (one_child[i] != FROZEN_NO_NODE) {
+			bottom_up_val[i] += bottom_up_val[one_child[i]];
+		}
+	}
+
+	assert(bottom_up_val[root] == top_down_val[terminal]);
+	const mpz_class& total_npaths = top_down_val[terminal];
+
+	// Compute center
+	center.resize(nlayers - 1);
+	for (int layer = 0; layer < nlayers - 1; ++layer) {
+		mpz_class center_sum = 0;
+		for (int i = layer_offset[layer]; i < layer_offset[layer + 1]; ++i) {
+			if (one_child[i] != FROZEN_NO_NODE) {
+				center_sum += top_down_val[i] + bottom_up_val[one_child[i]];
+			}
+		}
+		mpq_class center_val(center_sum, total_npaths);
+		center[layer] = center_val.get_d(); // convert back to double
+		assert(center[layer] >= 0 && center[layer] <= 1);
+	}
+
+	stats.end_timer(0);
+	cout << "Time to calculate center: " << stats.get_time(0) << endl;
+}
+
+#else
+
+void FrozenBDD::get_center(vector<double>& center) const
+{
+	cout << "Error: Using DD center as interior point requires compilation with GMP library" << endl;
+	exit(1);
+}
+
+#endif
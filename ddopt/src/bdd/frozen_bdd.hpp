@@ -0,0 +1,75 @@
+/**
+ * Compact read-only representation of a constructed decision diagram
+ */
+
+#ifndef FROZEN_BDD_HPP_
+#define FROZEN_BDD_HPP_
+
+#include <vector>
+#include <cstdint>
+#include "bdd_node.hpp"
+
+using namespace std;
+
+class BDD; // forward declaration
+
+#define FROZEN_NO_NODE -1
+
+
+/**
+ * Struct-of-arrays snapshot of a constructed BDD for algorithms that only read the diagram. Nodes are indexed layer by
+ * layer (index = layer_offset[layer] + id), so any array indexed by node follows the order of bdd->layers. Children are
+ * stored as 32-bit node indices and parents as a reverse CSR. The snapshot does not follow later modifications of the
+ * BDD; BDD drops it whenever nodes are added or removed.
+ */
+class FrozenBDD
+{
+public:
+	int               nlayers;          /**< number of layers (number of variables plus one) */
+	int               nnodes;           /**< number of nodes */
+	int               root;             /**< index of the root node */
+	int               terminal;         /**< index of the terminal node (the first node of the last layer) */
+
+	vector<int32_t>   layer_offset;     /**< nodes of layer k have indices layer_offset[k], ..., layer_offset[k+1]-1 */
+	vector<int32_t>   node_layer;       /**< layer of each node */
+	vector<int32_t>   zero_child;       /**< index of the 0-arc child of each node, or FROZEN_NO_NODE */
+	vector<int32_t>   one_child;        /**< index of the 1-arc child of each node, or FROZEN_NO_NODE */
+
+	vector<int32_t>   parent_offset;    /**< parent arcs of node i are parent_arcs[parent_offset[i]], ..., [parent_offset[i+1]-1] */
+	vector<int32_t>   parent_arcs;      /**< parent arcs encoded as 2 * parent + arc value, sorted in increasing order */
+
+	vector<uint64_t>  relaxed_bits;     /**< bitmap of relaxed nodes */
+
+	vector<int>       layer_to_var;     /**< copy of bdd->layer_to_var */
+	vector<Node*>     nodes;            /**< original node of each index, for functions that take nodes (e.g. pass functions) */
+
+
+	FrozenBDD(BDD* bdd);
+
+	/** Index of the node with the given layer and id */
+	int index(int layer, int id) const
+	{
+		return layer_offset[layer] + id;
+	}
+
+	/** Child of node i through the arc with the given value */
+	int child(int i, int val) const
+	{
+		return (val == 0) ? zero_child[i] : one_child[i];
+	}
+
+	bool is_relaxed(int i) const
+	{
+		return (relaxed_bits[i >> 6] >> (i & 63)) & 1;
+	}
+
+	/** Same as BDD::get_optimal_path_zero_one_coeffs, without touching the nodes */
+	double get_optimal_path_zero_one_coeffs(const vector<double>& zero_coeffs, const vector<double>& one_coeffs,
+	                                        vector<int>& optimal_path, bool maximize, bool ignore_relaxed_nodes = false) const;
+
+	/** Same as BDD::get_center */
+	void get_center(vector<double>& center) const; // Requires GMP
+};
+
+
+#endif /* FROZEN_BDD_HPP_ */
@@ -8,6 +8,7 @@
 #include <map>
 #include "../problem/problem.hpp"
 #include "../problem/state.hpp"
+#include "../util/slab.hpp"
 
 using namespace std;
 
@@ -40,6 +41,17 @@ class NodeDataMap
 public:
 	NodeDataMap() {}
 
+	/** Node data maps are created and deleted in large numbers; allocate them from slabs */
+	static void* operator new(size_t size)
+	{
+		return slab_allocate(size);
+	}
+
+	static void operator delete(void* ptr, size_t size)
+	{
+		slab_deallocate(ptr, size);
+	}
+
 	~NodeDataMap()
 	{
 		for (pair<const string, NodeData*>& p : data_map) {
@@ -0,0 +1,275 @@
+/**
+ * Parallel DD-based branch-and-bound
+ */
+
+#include <cassert>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include "branch_bound.hpp"
+
+
+DDBranchAndBound::DDBranchAndBound(const vector<Problem*>& _problems, int _restricted_width, Options* _options)
+	: problems(_problems), restricted_width(_restricted_width), options(_options)
+{
+	incumbent = -numeric_limits<double>::infinity();
+	shared_incumbent = incumbent;
+	dual_bound = numeric_limits<double>::infinity();
+	nsubproblems = 0;
+	time_limit_reached = false;
+
+	// DDs of subproblems are built by a single thread each and not traced, and the cutset needs the states of all nodes
+	dd_options = *options;
+	dd_options.quiet = true;
+	dd_options.nthreads = 1;
+	dd_options.delete_old_states = false;
+	dd_options.reduce_dd = false;
+	dd_options.refine_nodes = 0;
+	dd_options.trace_filename = "";
+}
+
+
+DDSolver* DDBranchAndBound::create_solver(Problem* prob)
+{
+	return new DDSolver(prob, &dd_options);
+}
+
+
+void DDBranchAndBound::solve(double time_limit /* = -1 */)
+{
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	int nthreads = problems.size();
+	WorkStealingQueue<BBSubproblem*> queue(nthreads);
+
+	BBSubproblem* root = new BBSubproblem();
+	root->state = problems[0]->create_initial_state();
+	root->longest_path = 0;
+	root->bound = numeric_limits<double>::infinity();
+	queue.push(0, root);
+
+	atomic<long> nprocessed(0);
+	atomic<bool> stop(false);
+
+	run_in_parallel(nthreads, [&](int t) {
+		while (!queue.done() && !stop) {
+			if (time_limit >= 0) {
+				chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+				if (elapsed.count() > time_limit) {
+					stop = true;
+					break;
+				}
+			}
+
+			BBSubproblem* sub;
+			if (!queue.pop(t, sub)) {
+				this_thread::yield(); // other threads may still push subproblems
+				continue;
+			}
+
+			process_subproblem(t, sub, queue);
+			delete sub->state;
+			delete sub;
+			nprocessed++;
+			queue.finish();
+		}
+	});
+
+	nsubproblems = nprocessed;
+	time_limit_reached = stop;
+
+	// Subproblems left open at the time limit bound the optimal value
+	dual_bound = incumbent;
+	vector<BBSubproblem*> open_subproblems;
+	queue.extract_all(open_subproblems);
+	for (BBSubproblem* sub : open_subproblems) {
+		dual_bound = MAX(dual_bound, sub->bound);
+		delete sub->state;
+		delete sub;
+	}
+}
+
+
+void DDBranchAndBound::process_subproblem(int t, BBSubproblem* sub, WorkStealingQueue<BBSubproblem*>& queue)
+{
+	Problem* prob = problems[t];
+	vector<double> weights(prob->inst->weights, prob->inst->weights + prob->inst->nvars);
+	vector<int> sol;
+
+	if (DBL_LE(sub->bound, shared_incumbent)) {
+		return;
+	}
+
+	// Restricted DD: may improve the incumbent
+	DDSolver* solver = create_solver(prob);
+	if (prob->completion != NULL) {
+		solver->set_primal_bound(shared_incumbent);
+	}
+	BDD* bdd = solver->construct_restricted_decision_diagram_at_state(sub->state->clone(), sub->longest_path,
+	           restricted_width);
+	if (bdd != NULL) {
+		// Paths of the DD start at the root of the subproblem, whose longest path is not part of their values
+		double value = sub->longest_path + bdd->get_optimal_sol(weights, sol, true);
+		update_incumbent(value, complete_solution(sub, sol));
+	}
+	delete bdd;
+	delete solver;
+
+	// Relaxed DD: prunes or branches
+	solver = create_solver(prob);
+	if (prob->completion != NULL) {
+		solver->set_primal_bound(shared_incumbent);
+	}
+	bdd = solver->construct_decision_diagram_at_state(sub->state, sub->longest_path);
+	sub->state = NULL; // owned by the root node of the DD
+	delete solver;
+
+	if (bdd == NULL || DBL_LE(bdd->bound, shared_incumbent)) {
+		delete bdd;
+		return;
+	}
+
+	// Mark exact nodes, and compute in lp_value the longest path from each node to the terminal
+	int root_layer = bdd->get_root_layer();
+	int terminal_layer = bdd->get_terminal_layer();
+	vector<vector<char>> exact(bdd->layers.size());
+	for (int layer = root_layer; layer <= terminal_layer; ++layer) {
+		exact[layer].assign(bdd->layers[layer].size(), false);
+		for (Node* node : bdd->layers[layer]) {
+			bool node_exact = !node->relaxed_node;
+			for (Node* parent : node->zero_ancestors) {
+				node_exact = node_exact && exact[parent->layer][parent->id];
+			}
+			for (Node* parent : node->one_ancestors) {
+				node_exact = node_exact && exact[parent->layer][parent->id];
+			}
+			exact[layer][node->id] = node_exact;
+		}
+	}
+	for (int layer = terminal_layer; layer >= root_layer; --layer) {
+		for (Node* node : bdd->layers[layer]) {
+			node->lp_value = (layer == terminal_layer) ? 0 : -numeric_limits<double>::infinity();
+			if (node->zero_arc != NULL) {
+				node->lp_value = MAX(node->lp_value, node->zero_arc->lp_value);
+			}
+			if (node->one_arc != NULL) {
+				node->lp_value = MAX(node->lp_value, weights[bdd->layer_to_var[layer]] + node->one_arc->lp_value);
+			}
+		}
+	}
+
+	// Exact DD: subproblem is solved
+	Node* terminal = bdd->get_terminal_node();
+	if (exact[terminal_layer][terminal->id]) {
+		double value = sub->longest_path + bdd->get_optimal_sol(weights, sol, true);
+		update_incumbent(value, complete_solution(sub, sol));
+		delete bdd;
+		return;
+	}
+
+	// Branch on the exact cutset
+	Node* root = bdd->get_root_node();
+	for (int layer = root_layer; layer < terminal_layer; ++layer) {
+		for (Node* node : bdd->layers[layer]) {
+			if (!exact[layer][node->id]) {
+				continue;
+			}
+			bool in_cutset = (node->zero_arc != NULL && !exact[node->zero_arc->layer][node->zero_arc->id])
+			                 || (node->one_arc != NULL && !exact[node->one_arc->layer][node->one_arc->id]);
+			if (!in_cutset || DBL_LE(node->longest_path + node->lp_value, shared_incumbent)) {
+				continue;
+			}
+
+			if (node == root) {
+				// Branching on the root would give the same subproblem; branch on its variable instead
+				int var = bdd->layer_to_var[layer];
+				for (int val = 0; val <= 1; ++val) {
+					State* state = root->state->transition(prob, var, val);
+					if (state == NULL) {
+						continue;
+					}
+					BBSubproblem* child = new BBSubproblem();
+					child->state = state;
+					child->longest_path = root->longest_path + val * weights[var];
+					child->bound = bdd->bound;
+					child->one_vars = sub->one_vars;
+					if (val == 1) {
+						child->one_vars.push_back(var);
+					}
+					queue.push(t, child);
+				}
+				continue;
+			}
+
+			BBSubproblem* child = new BBSubproblem();
+			child->state = node->state;
+			node->state = NULL;
+			child->longest_path = node->longest_path;
+			child->bound = node->longest_path + node->lp_value;
+			child->one_vars = sub->one_vars;
+			add_best_path_to_node(bdd, node, child->one_vars);
+			queue.push(t, child);
+		}
+	}
+
+	delete bdd;
+}
+
+
+void DDBranchAndBound::add_best_path_to_node(BDD* bdd, Node* node, vector<int>& one_vars)
+{
+	const double* weights = problems[0]->inst->weights;
+	Node* root = bdd->get_root_node();
+
+	// Longest paths of exact nodes are exact, so some parent attains the longest path of its child
+	while (node != root) {
+		Node* next = NULL;
+		for (Node* parent : node->one_ancestors) {
+			int var = bdd->layer_to_var[parent->layer];
+			if (DBL_EQ(parent->longest_path + weights[var], node->longest_path)) {
+				one_vars.push_back(var);
+				next = parent;
+				break;
+			}
+		}
+		if (next == NULL) {
+			for (Node* parent : node->zero_ancestors) {
+				if (DBL_EQ(parent->longest_path, node->longest_path)) {
+					next = parent;
+					break;
+				}
+			}
+		}
+		assert(next != NULL);
+		node = next;
+	}
+}
+
+
+vector<int> DDBranchAndBound::complete_solution(BBSubproblem* sub, const vector<int>& sol)
+{
+	vector<int> one_vars = sub->one_vars;
+	for (int var = 0; var < (int) sol.size(); ++var) {
+		if (sol[var] == 1) {
+			one_vars.push_back(var);
+		}
+	}
+	sort(one_vars.begin(), one_vars.end());
+	one_vars.erase(unique(one_vars.begin(), one_vars.end()), one_vars.end());
+	return one_vars;
+}
+
+
+void DDBranchAndBound::update_incumbent(double value, const vector<int>& sol)
+{
+	lock_guard<mutex> guard(incumbent_lock);
+	if (value <= incumbent) {
+		return;
+	}
+	incumbent = value;
+	incumbent_sol = sol;
+	shared_incumbent = value;
+	if (!options->quiet) {
+		cout << "Incumbent: " << value << endl;
+	}
+}
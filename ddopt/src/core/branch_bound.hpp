@@ -0,0 +1,106 @@
+/**
+ * Parallel DD-based branch-and-bound
+ */
+
+#ifndef BRANCH_BOUND_HPP_
+#define BRANCH_BOUND_HPP_
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include "solver.hpp"
+
+using namespace std;
+
+
+/** Subproblem of the branch-and-bound: an exact node of a previous DD, to be expanded into its own DDs */
+struct BBSubproblem {
+	State*        state;           /**< state of the node (owned by the subproblem) */
+	double        longest_path;    /**< value of the best path to the node */
+	double        bound;           /**< upper bound on the best solution through the node */
+	vector<int>   one_vars;        /**< variables set to one in the best path to the node */
+};
+
+
+/**
+ * DD-based branch-and-bound. Each subproblem is solved by a restricted DD, which may improve the incumbent, and a
+ * relaxed DD. If the relaxed DD is not exact and its bound is better than the incumbent, the subproblem is branched on
+ * the exact cutset of the relaxed DD: the exact nodes with a child that is not exact (a node is exact if it is not
+ * relaxed and all of its parents are exact). Each path goes through at least one such node, so the nodes of the cutset
+ * become the new subproblems.
+ *
+ * Subproblems are distributed to threads through a work-stealing queue, and the incumbent is shared by all threads to
+ * prune subproblems and, if the problem has a completion bound, nodes of the DDs. Each thread has its own problem; the
+ * problem must support DDs starting at the state of a node of another DD, skipping the variables already decided with
+ * long arcs (see Problem::cb_skip_var_for_long_arc).
+ */
+class DDBranchAndBound
+{
+public:
+
+	double                        incumbent;                   /**< value of the best solution found */
+	vector<int>                   incumbent_sol;               /**< variables set to one in the best solution found */
+	double                        dual_bound;                  /**< upper bound on the optimal value after solving */
+	long                          nsubproblems;                /**< number of subproblems processed */
+	bool                          time_limit_reached;          /**< true if solving stopped at the time limit */
+
+	/**
+	 * Create a branch-and-bound with one problem per thread; problems are owned by the caller. The relaxed width is the
+	 * width of the mergers of the problems and restricted_width the width of restricted DDs.
+	 */
+	DDBranchAndBound(const vector<Problem*>& _problems, int _restricted_width, Options* _options);
+
+	virtual ~DDBranchAndBound() {}
+
+	/** Solve the problem, stopping after time_limit seconds of wall-clock time (no limit if negative) */
+	void solve(double time_limit = -1);
+
+protected:
+
+	/** Create a DD solver for the given problem */
+	virtual DDSolver* create_solver(Problem* prob);
+
+	Options                       dd_options;                  /**< options for DD construction within subproblems */
+
+private:
+
+	vector<Problem*>              problems;                    /**< problem of each thread */
+	int                           restricted_width;
+	Options*                      options;
+
+	mutex                         incumbent_lock;
+	atomic<double>                shared_incumbent;            /**< copy of incumbent that can be read without the lock */
+
+	/** Solve a subproblem with the problem of thread t, pushing the subproblems it branches into */
+	void process_subproblem(int t, BBSubproblem* sub, WorkStealingQueue<BBSubproblem*>& queue);
+
+	/** Update incumbent if the given solution is better */
+	void update_incumbent(double value, const vector<int>& sol);
+
+	/** Return the variables set to one in the given solution together with those of the subproblem */
+	vector<int> complete_solution(BBSubproblem* sub, const vector<int>& sol);
+
+	/** Add the variables set to one in a best path from the root of the DD to an exact node */
+	void add_best_path_to_node(BDD* bdd, Node* node, vector<int>& one_vars);
+};
+
+
+/** Branch-and-bound for a specific problem type, using TypedDDSolver to construct DDs */
+template<class ProblemT>
+class TypedDDBranchAndBound : public DDBranchAndBound
+{
+public:
+
+	TypedDDBranchAndBound(const vector<Problem*>& _problems, int _restricted_width, Options* _options)
+		: DDBranchAndBound(_problems, _restricted_width, _options) {}
+
+protected:
+
+	DDSolver* create_solver(Problem* prob)
+	{
+		return new TypedDDSolver<ProblemT>(static_cast<ProblemT*>(prob), &dd_options);
+	}
+};
+
+
+#endif /* BRANCH_BOUND_HPP_ */
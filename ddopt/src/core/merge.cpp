@@ -3,6 +3,7 @@
  */
 
 #include "merge.hpp"
+#include "../problem/problem.hpp"
 
 Node* find_equivalent_state(vector<Node*>& nodes_list, Node* node)
 {
@@ -13,3 +14,34 @@ Node* find_equivalent_state(vector<Node*>& nodes_list, Node* node)
 	}
 	return NULL;
 }
+
+
+bool use_ordered_node_pool(Problem* prob)
+{
+	return prob->options != NULL && prob->options->ordered_node_pool;
+}
+
+
+int get_merge_nthreads(Problem* prob)
+{
+	return (prob->options != NULL) ? MAX(1, prob->options->nthreads) : 1;
+}
+
+
+void drop_node(Node* node)
+{
+	assert(node->zero_arc == NULL && node->one_arc == NULL);
+	for (Node* parent : node->zero_ancestors) {
+		parent->zero_arc = NULL;
+	}
+	for (Node* parent : node->one_ancestors) {
+		parent->one_arc = NULL;
+	}
+	delete node;
+}
+
+
+void Merger::restrict_layer(Problem* prob, int layer, vector<Node*>& nodes_layer)
+{
+	drop_nodes_past_width(nodes_layer, width, CompareNodesLongestPath());
+}
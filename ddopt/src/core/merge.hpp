@@ -6,7 +6,16 @@
 #define MERGE_HPP_
 
 #include <cassert>
+#include <algorithm>
+#include <set>
+#include <queue>
+#include <limits>
+#include <unordered_map>
 #include "../bdd/bdd.hpp"
+#include "../util/parallel.hpp"
+#include "node_pool.hpp"
+
+#define PARALLEL_PAIRS_MIN_NODES  256     /**< minimum layer size for multi-threaded evaluation of pairs in merge_nodes_pairs_value */
 
 
 /** Node merging for decision diagrams */
@@ -20,6 +29,12 @@ struct Merger {
 
 	/** Return vertex corresponding to given layer */
 	virtual void merge_layer(Problem* prob, int layer, vector<Node*>& nodes_layer) = 0;
+
+	/**
+	 * Drop nodes of the layer until it is within width, used to construct restricted DDs. Mergers should drop nodes in
+	 * the same order they would merge them; by default, nodes with the smallest longest path are dropped.
+	 */
+	virtual void restrict_layer(Problem* prob, int layer, vector<Node*>& nodes_layer);
 };
 
 
@@ -36,19 +51,196 @@ struct NoSorting {
 };
 
 
+/**
+ * Whether a node comparator is a strict order, i.e. no two nodes of a layer compare equal. Only then do nth_element and
+ * IndexedNodeHeap arrange nodes as a full sort does; comparators with ties (e.g. CompareNodesLongestPath) keep full sorts
+ * so that ties are resolved as they always were. Specialize to true_type for strict comparators.
+ */
+template <class Compare>
+struct is_strict_node_order : false_type {};
+
+
 /** Find an equivalent node (with respect to state) in a list of nodes */
 Node* find_equivalent_state(vector<Node*>& nodes_list, Node* node);
 
+/** Return true if node pools for this problem should be ordered (see NodePool) */
+bool use_ordered_node_pool(Problem* prob);
+
+/** Number of threads that merging functions may use for this problem */
+int get_merge_nthreads(Problem* prob);
+
+/** Remove all arcs into a node that has no children and delete it */
+void drop_node(Node* node);
+
+
+/**
+ * Binary heap of nodes whose top is the last node in comparator order, indexed by node so that a node whose position in
+ * the order changed can be moved in logarithmic time. Ties of the comparator are broken by global id, so that the order of
+ * the heap is strict.
+ */
+template <class Compare>
+class IndexedNodeHeap
+{
+	vector<Node*>              heap;
+	unordered_map<Node*, int>  position;     /**< position of each node in heap */
+	Compare                    comparator;
+
+	void place(int i, Node* node)
+	{
+		heap[i] = node;
+		position[node] = i;
+	}
+
+	/** Return true if nodeA comes before nodeB in the order of the heap */
+	bool before(Node* nodeA, Node* nodeB) const
+	{
+		if (comparator(nodeA, nodeB)) {
+			return true;
+		}
+		if (comparator(nodeB, nodeA)) {
+			return false;
+		}
+		return nodeA->global_id < nodeB->global_id;
+	}
+
+	void sift_up(int i)
+	{
+		Node* node = heap[i];
+		while (i > 0) {
+			int parent = (i - 1) / 2;
+			if (!before(heap[parent], node)) {
+				break;
+			}
+			place(i, heap[parent]);
+			i = parent;
+		}
+		place(i, node);
+	}
+
+	void sift_down(int i)
+	{
+		Node* node = heap[i];
+		int n = heap.size();
+		while (2 * i + 1 < n) {
+			int child = 2 * i + 1;
+			if (child + 1 < n && before(heap[child], heap[child + 1])) {
+				child++;
+			}
+			if (!before(node, heap[child])) {
+				break;
+			}
+			place(i, heap[child]);
+			i = child;
+		}
+		place(i, node);
+	}
+
+public:
+
+	IndexedNodeHeap(const vector<Node*>& nodes, Compare _comparator) : heap(nodes), comparator(_comparator)
+	{
+		position.reserve(heap.size());
+		for (int i = 0; i < (int) heap.size(); ++i) {
+			position[heap[i]] = i;
+		}
+		for (int i = (int) heap.size() / 2 - 1; i >= 0; --i) {
+			sift_down(i);
+		}
+	}
+
+	int size() const
+	{
+		return heap.size();
+	}
+
+	/** Remove and return the last node in comparator order */
+	Node* pop()
+	{
+		Node* top = heap[0];
+		remove(top);
+		return top;
+	}
+
+	void push(Node* node)
+	{
+		heap.push_back(node);
+		sift_up(heap.size() - 1);
+	}
+
+	void remove(Node* node)
+	{
+		int i = position[node];
+		position.erase(node);
+		Node* last = heap.back();
+		heap.pop_back();
+		if (i < (int) heap.size()) {
+			place(i, last);
+			update(last);
+		}
+	}
+
+	/** Restore the heap order after the key of a node changed */
+	void update(Node* node)
+	{
+		sift_up(position[node]);
+		sift_down(position[node]);
+	}
+
+	/** Nodes in the order of the heap */
+	vector<Node*> get_sorted_nodes() const
+	{
+		vector<Node*> nodes(heap);
+		sort(nodes.begin(), nodes.end(), [this](Node* nodeA, Node* nodeB) {
+			return before(nodeA, nodeB);
+		});
+		return nodes;
+	}
+};
+
 
-/** Merge all nodes past a given width at once. Equivalence check is only done at the end of merging. */
+/**
+ * Drop all nodes past a given width, keeping the first ones according to the comparator (if any). With a strict comparator
+ * (see is_strict_node_order), the nodes kept are selected in linear time and only they are sorted.
+ */
+template <class Compare = NoSorting>
+void drop_nodes_past_width(vector<Node*>& nodes_layer, int width, Compare comparator = NoSorting())
+{
+	bool use_sorting = !is_same<Compare,NoSorting>::value;
+
+	if (use_sorting) {
+		if (is_strict_node_order<Compare>::value) {
+			nth_element(nodes_layer.begin(), nodes_layer.begin() + width, nodes_layer.end(), comparator);
+			sort(nodes_layer.begin(), nodes_layer.begin() + width, comparator);
+		} else {
+			sort(nodes_layer.begin(), nodes_layer.end(), comparator);
+		}
+	}
+
+	for (vector<Node*>::iterator node = nodes_layer.begin()+width; node != nodes_layer.end(); ++node) {
+		drop_node(*node);
+	}
+	nodes_layer.resize(width);
+}
+
+
+/**
+ * Merge all nodes past a given width at once. Equivalence check is only done at the end of merging. With a strict
+ * comparator (see is_strict_node_order) and a hashed node pool, the node at width - 1 is selected in linear time and only
+ * the nodes before it are sorted; the nodes merged into it are left unsorted. Otherwise, the whole layer is sorted.
+ */
 template <class Compare = NoSorting>
 void merge_nodes_past_width_at_once(Problem* prob, vector<Node*>& nodes_layer, int width, Compare comparator = NoSorting())
 {
 	bool use_sorting = !is_same<Compare,NoSorting>::value;
 
-	// Sort nodes
+	// Sort nodes, or only select the nodes that are kept
 	if (use_sorting) {
-		sort(nodes_layer.begin(), nodes_layer.end(), comparator);
+		if (is_strict_node_order<Compare>::value && !use_ordered_node_pool(prob)) {
+			nth_element(nodes_layer.begin(), nodes_layer.begin() + width - 1, nodes_layer.end(), comparator);
+			sort(nodes_layer.begin(), nodes_layer.begin() + width - 1, comparator);
+		} else {
+			sort(nodes_layer.begin(), nodes_layer.end(), comparator);
+		}
 	}
 
 	// Merge nodes
@@ -69,21 +261,69 @@ void merge_nodes_past_width_at_once(Problem* prob, vector<Node*>& nodes_layer, i
 }
 
 
-/** Merge all nodes past a given width iteratively. Equivalence check is done at the end of each iteration. */
+/**
+ * Merge the last two nodes according to the comparator until within width, with the nodes kept in an indexed heap so that
+ * each merge takes logarithmic time. Ties of the comparator are broken by global id (see IndexedNodeHeap). Equivalence
+ * check is done at the end of each iteration. Nodes are left sorted.
+ */
+template <class Compare>
+void merge_nodes_past_width_iteratively_heap(Problem* prob, vector<Node*>& nodes_layer, int width, Compare comparator)
+{
+	NodePool current_states(use_ordered_node_pool(prob));
+	for (Node* node : nodes_layer) {
+		current_states.insert(node);
+	}
+
+	IndexedNodeHeap<Compare> heap(nodes_layer, comparator);
+	while (heap.size() > width) {
+
+		// merge the last node into the one before it
+		Node* last_node = heap.pop();
+		Node* merged_node = heap.pop();
+		current_states.erase(merged_node->state);
+		current_states.erase(last_node->state);
+		merged_node->merge(prob, last_node);
+		delete last_node;
+
+		// now, we must check if the state of the new node appears in any other node
+		Node* equivalent_node = current_states.find(merged_node->state);
+		if (equivalent_node != NULL) {
+			equivalent_node->merge(prob, merged_node);
+			delete merged_node;
+			heap.update(equivalent_node);
+		} else {
+			current_states.insert(merged_node);
+			heap.push(merged_node);
+		}
+	}
+
+	nodes_layer = heap.get_sorted_nodes();
+}
+
+
+/**
+ * Merge all nodes past a given width iteratively. Equivalence check is done at the end of each iteration. With a
+ * comparator, the two last nodes in its order are merged at each iteration (see merge_nodes_past_width_iteratively_heap),
+ * except that with an ordered node pool and a comparator that is not strict, the layer is sorted again after each merge so
+ * that ties are resolved as they always were. Without a comparator, the two last nodes of the layer are merged.
+ */
 template <class Compare = NoSorting>
 void merge_nodes_past_width_iteratively(Problem* prob, vector<Node*>& nodes_layer, int width, Compare comparator = NoSorting())
 {
 	bool use_sorting = !is_same<Compare,NoSorting>::value;
-	NodeMap current_states;
+	if (use_sorting && (is_strict_node_order<Compare>::value || !use_ordered_node_pool(prob))) {
+		merge_nodes_past_width_iteratively_heap(prob, nodes_layer, width, comparator);
+		return;
+	}
 
+	NodePool current_states(use_ordered_node_pool(prob));
 	if (use_sorting) {
 		sort(nodes_layer.begin(), nodes_layer.end(), comparator);
 	}
 
 	// populate current states with given nodes for equivalence checks
-	current_states.clear();
 	for (vector<Node*>::iterator node = nodes_layer.begin(); node != nodes_layer.end(); ++node) {
-		current_states[(*node)->state] = *node;
+		current_states.insert(*node);
 	}
 
 	// merge nodes from the end of the list until max. width is reached
@@ -104,12 +344,12 @@ void merge_nodes_past_width_iteratively(Problem* prob, vector<Node*>& nodes_laye
 		current_size--;
 
 		// now, we must check if the state of the new node appears in any previous node
-		NodeMap::iterator map_it = current_states.find(nodes_layer[current_size-1]->state);
-		if (map_it != current_states.end()) {
+		Node* equivalent_node = current_states.find(nodes_layer[current_size-1]->state);
+		if (equivalent_node != NULL) {
 
 			// merge nodes
-			// cout << "Merging " << *(nodes_layer[current_size-1]->state) << " with " << *(map_it->second->state) << endl;
-			map_it->second->merge(prob, nodes_layer[current_size-1]);
+			// cout << "Merging " << *(nodes_layer[current_size-1]->state) << " with " << *(equivalent_node->state) << endl;
+			equivalent_node->merge(prob, nodes_layer[current_size-1]);
 
 			// remove last node from layer
 			delete nodes_layer[current_size-1];
@@ -118,7 +358,7 @@ void merge_nodes_past_width_iteratively(Problem* prob, vector<Node*>& nodes_laye
 
 		} else {
 			// otherwise, we add the node to the set of current states
-			current_states[nodes_layer[current_size-1]->state] = nodes_layer[current_size-1];
+			current_states.insert(nodes_layer[current_size-1]);
 		}
 
 		// ensure modified node falls into correct order
@@ -129,7 +369,7 @@ void merge_nodes_past_width_iteratively(Problem* prob, vector<Node*>& nodes_laye
 }
 
 
-/** Merge consecutive pairs of nodes until within width. */
+/** Merge consecutive pairs of nodes until within width. Equivalent states are found in a pool of the nodes of the layer. */
 template <class Compare = NoSorting>
 void merge_nodes_past_width_consecutive_pairs(Problem* prob, vector<Node*>& nodes_layer, int width, Compare comparator = NoSorting())
 {
@@ -137,6 +377,11 @@ void merge_nodes_past_width_consecutive_pairs(Problem* prob, vector<Node*>& node
 	vector<Node*> old_nodes;
 	Node* equivalent_node;
 
+	NodePool current_states(use_ordered_node_pool(prob));
+	for (Node* node : nodes_layer) {
+		current_states.insert(node);
+	}
+
 	// merge while maximum width is not met
 	while (old_nodes.size() + nodes_layer.size() > (unsigned int)width) {
 
@@ -163,24 +408,20 @@ void merge_nodes_past_width_consecutive_pairs(Problem* prob, vector<Node*>& node
 			old_nodes.pop_back();
 
 			// merge into node A
+			current_states.erase(nodeA->state);
+			current_states.erase(nodeB->state);
 			nodeA->merge(prob, nodeB);
 			delete nodeB;
 
-			// equivalence check in old_nodes
-			equivalent_node = find_equivalent_state(old_nodes, nodeA);
+			// equivalence check in old_nodes and nodes_layer
+			equivalent_node = current_states.find(nodeA->state);
 			if (equivalent_node != NULL) {
 				equivalent_node->merge(prob, nodeA, true);
 				delete nodeA;
 			} else {
-				// equivalence check in nodes_layer
-				equivalent_node = find_equivalent_state(nodes_layer, nodeA);
-				if (equivalent_node != NULL) {
-					equivalent_node->merge(prob, nodeA, true);
-					delete nodeA;
-				} else {
-					// node is new
-					nodes_layer.push_back(nodeA);
-				}
+				// node is new
+				current_states.insert(nodeA);
+				nodes_layer.push_back(nodeA);
 			}
 
 		}
@@ -194,51 +435,194 @@ void merge_nodes_past_width_consecutive_pairs(Problem* prob, vector<Node*>& node
 }
 
 
-/** Merge pairs that minimize or maximize a function that takes pairs of nodes into account */
-template <class ValFunc>
-void merge_nodes_pairs_value(Problem* prob, vector<Node*>& nodes_layer, int width, ValFunc value_function, bool maximize = true)
+/** Artificial bound key that signals to merge_nodes_pairs_value that no bound on the values of pairs is known */
+struct NoPairBound {
+	double operator()(const Node* node) const
+	{
+		assert(false); // Bound key should not be used
+		exit(1);
+		return 0;
+	}
+};
+
+
+/** Pair of nodes with the best value found for one of them, its owner, among the other nodes at that time */
+struct MergePairCandidate {
+	double    cost;            /**< value of the pair, negated if maximizing */
+	int       first;           /**< smaller position of the pair in the layer */
+	int       second;          /**< larger position of the pair in the layer */
+	int       owner;           /**< position of the node whose best partner this is */
+	int       first_version;   /**< number of times the node at first had changed when the pair was evaluated */
+	int       second_version;  /**< number of times the node at second had changed when the pair was evaluated */
+};
+
+/** Order of candidates in the priority queue: smallest cost on top, then smallest positions, as a scan of all pairs */
+struct CompareMergePairCandidates {
+	bool operator()(const MergePairCandidate& a, const MergePairCandidate& b) const
+	{
+		if (a.cost != b.cost) {
+			return a.cost > b.cost;
+		}
+		if (a.first != b.first) {
+			return a.first > b.first;
+		}
+		return a.second > b.second;
+	}
+};
+
+
+/**
+ * Merge pairs that minimize or maximize a function that takes pairs of nodes into account; the function must be
+ * symmetric. The pair merged at each step is the one a scan of all pairs would take, with ties broken by position in
+ * the layer.
+ *
+ * The best partner of each node is kept in a priority queue of candidate pairs, updated lazily: a candidate whose
+ * partner was merged since is re-evaluated only when it reaches the top, and a merged node gets a new candidate. If
+ * bound_key is given, value_function(A, B) must be at least bound_key(A) + bound_key(B) when minimizing (at most when
+ * maximizing); nodes are then scanned by key and the search for a best partner stops at the first node whose key
+ * cannot improve on it. Best partners of the nodes of the layer are found in parallel if the problem has several threads.
+ */
+template <class ValFunc, class BoundKey = NoPairBound>
+void merge_nodes_pairs_value(Problem* prob, vector<Node*>& nodes_layer, int width, ValFunc value_function,
+                             bool maximize = true, BoundKey bound_key = BoundKey())
 {
-	while ((int) nodes_layer.size() > width) {
-		Node* node1_to_merge = NULL;
-		Node* node2_to_merge = NULL;
+	int n = nodes_layer.size();
+	if (n <= width) {
+		return;
+	}
 
-		double value;
-		if (maximize) {
-			value = -numeric_limits<double>::infinity();
-		} else {
-			value = numeric_limits<double>::infinity();
-		}
-
-		// Take pair of nodes that maximize/minimize the function
-		for (vector<Node*>::iterator it1 = nodes_layer.begin(); it1 != nodes_layer.end(); ++it1) {
-			Node* node1 = *it1;
-			for (vector<Node*>::iterator it2 = it1 + 1; it2 != nodes_layer.end(); ++it2) {
-				Node* node2 = *it2;
-				if (node1 == node2) {
-					continue;
-				}
-
-				double cur_value = value_function(node1, node2);
-				if ((maximize && cur_value > value) ||
-				        (!maximize && cur_value < value)) {
-					node1_to_merge = node1;
-					node2_to_merge = node2;
-					value = cur_value;
-				}
+	bool use_bound = !is_same<BoundKey,NoPairBound>::value;
+	double sign = maximize ? -1 : 1; // values are minimized as sign * value
+
+	// Nodes by position in the layer; merged nodes become NULL
+	vector<Node*> nodes(nodes_layer);
+	vector<int> version(n, 0);
+	vector<double> key(n, 0);
+	set<pair<double,int>> nodes_by_key;
+	unordered_map<Node*, int> position;
+	NodePool current_states(use_ordered_node_pool(prob));
+	for (int i = 0; i < n; ++i) {
+		if (use_bound) {
+			key[i] = sign * bound_key(nodes[i]);
+		}
+		nodes_by_key.insert(make_pair(key[i], i));
+		position[nodes[i]] = i;
+		current_states.insert(nodes[i]);
+	}
+
+	// Best partner of a node among the other nodes, with ties broken by the positions of the pair
+	auto find_best_partner = [&](int owner) {
+		MergePairCandidate best;
+		best.cost = numeric_limits<double>::infinity();
+		best.first = best.second = n;
+		best.owner = owner;
+		for (set<pair<double,int>>::const_iterator it = nodes_by_key.begin(); it != nodes_by_key.end(); ++it) {
+			if (use_bound && DBL_GT(key[owner] + it->first, best.cost)) {
+				break;
 			}
+			int other = it->second;
+			if (other == owner) {
+				continue;
+			}
+			int first = MIN(owner, other);
+			int second = MAX(owner, other);
+			double cost = sign * value_function(nodes[first], nodes[second]);
+			if (cost < best.cost || (cost == best.cost && (first < best.first || (first == best.first && second < best.second)))) {
+				best.cost = cost;
+				best.first = first;
+				best.second = second;
+			}
+		}
+		if (best.second < n) {
+			best.first_version = version[best.first];
+			best.second_version = version[best.second];
+		}
+		return best;
+	};
+
+	// Best partners of all nodes; values cached by states are computed by the first evaluation of each node, before
+	// threads share them
+	vector<MergePairCandidate> initial(n);
+	int nthreads = get_merge_nthreads(prob);
+	if (nthreads > 1 && n >= PARALLEL_PAIRS_MIN_NODES) {
+		if (!use_bound) {
+			for (int i = 0; i < n; ++i) {
+				value_function(nodes[i], nodes[i]);
+			}
+		}
+		run_in_parallel(nthreads, [&](int t) {
+			for (int i = t; i < n; i += nthreads) {
+				initial[i] = find_best_partner(i);
+			}
+		});
+	} else {
+		for (int i = 0; i < n; ++i) {
+			initial[i] = find_best_partner(i);
+		}
+	}
+	priority_queue<MergePairCandidate, vector<MergePairCandidate>, CompareMergePairCandidates> candidates(
+	    CompareMergePairCandidates(), initial);
+
+	int nnodes = n;
+	while (nnodes > width) {
+		assert(!candidates.empty());
+		MergePairCandidate candidate = candidates.top();
+		candidates.pop();
+
+		// Drop candidates of nodes that changed since, and re-evaluate those whose partner did
+		int owner_version = (candidate.owner == candidate.first) ? candidate.first_version : candidate.second_version;
+		if (nodes[candidate.owner] == NULL || version[candidate.owner] != owner_version) {
+			continue;
+		}
+		if (nodes[candidate.first] == NULL || nodes[candidate.second] == NULL
+		        || version[candidate.first] != candidate.first_version || version[candidate.second] != candidate.second_version) {
+			candidates.push(find_best_partner(candidate.owner));
+			continue;
 		}
 
 		// Merge pair of nodes
+		int first = candidate.first;
+		int second = candidate.second;
+		Node* node1_to_merge = nodes[first];
+		Node* node2_to_merge = nodes[second];
+		current_states.erase(node1_to_merge->state);
+		current_states.erase(node2_to_merge->state);
+		nodes_by_key.erase(make_pair(key[first], first));
+		nodes_by_key.erase(make_pair(key[second], second));
 		node1_to_merge->merge(prob, node2_to_merge);
-		nodes_layer.erase(remove(nodes_layer.begin(), nodes_layer.end(), node2_to_merge), nodes_layer.end());
 		delete node2_to_merge;
+		nodes[second] = NULL;
+		nnodes--;
 
 		// Equivalence test on new node (i.e. check if state already exists in other nodes)
-		Node* equivalent_node = find_equivalent_state(nodes_layer, node1_to_merge);
+		int changed = first;
+		Node* equivalent_node = current_states.find(node1_to_merge->state);
 		if (equivalent_node != NULL) {
+			changed = position[equivalent_node];
+			nodes_by_key.erase(make_pair(key[changed], changed));
 			equivalent_node->merge(prob, node1_to_merge, true);
-			nodes_layer.erase(remove(nodes_layer.begin(), nodes_layer.end(), node1_to_merge), nodes_layer.end());
 			delete node1_to_merge;
+			nodes[first] = NULL;
+			nnodes--;
+		} else {
+			current_states.insert(node1_to_merge);
+		}
+
+		// The node that changed gets a new candidate
+		version[changed]++;
+		if (use_bound) {
+			key[changed] = sign * bound_key(nodes[changed]);
+		}
+		nodes_by_key.insert(make_pair(key[changed], changed));
+		if (nnodes > width) {
+			candidates.push(find_best_partner(changed));
+		}
+	}
+
+	nodes_layer.clear();
+	for (Node* node : nodes) {
+		if (node != NULL) {
+			nodes_layer.push_back(node);
 		}
 	}
 }
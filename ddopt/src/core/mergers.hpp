@@ -61,6 +61,10 @@ struct NodeStateLexLessThan {
 	}
 };
 
+/** Nodes of a layer have distinct states, so the lexicographic order is strict */
+template <>
+struct is_strict_node_order<NodeStateLexLessThan> : true_type {};
+
 // Lexicographic merger
 struct LexicographicMerger : Merger {
 	LexicographicMerger(int _width) : Merger(_width, "lex") {}
@@ -69,6 +73,11 @@ struct LexicographicMerger : Merger {
 	{
 		merge_nodes_past_width_iteratively(prob, nodes_layer, this->width, NodeStateLexLessThan());
 	}
+
+	void restrict_layer(Problem* prob, int layer, vector<Node*>& nodes_layer)
+	{
+		drop_nodes_past_width(nodes_layer, this->width, NodeStateLexLessThan());
+	}
 };
 
 
@@ -81,6 +90,12 @@ struct RandomMerger : Merger {
 		random_shuffle(nodes_layer.begin(), nodes_layer.end());
 		merge_nodes_past_width_at_once(prob, nodes_layer, this->width);
 	}
+
+	void restrict_layer(Problem* prob, int layer, vector<Node*>& nodes_layer)
+	{
+		random_shuffle(nodes_layer.begin(), nodes_layer.end());
+		drop_nodes_past_width(nodes_layer, this->width);
+	}
 };
 
 
@@ -0,0 +1,122 @@
+/**
+ * Pool of nodes keyed by state, used to identify equivalent states during construction
+ */
+
+#include <cassert>
+#include <algorithm>
+#include "node_pool.hpp"
+
+
+/** Comparator to sort nodes by order of creation */
+struct CompareNodesGlobalId {
+	bool operator()(const Node* nodeA, const Node* nodeB) const
+	{
+		return nodeA->global_id < nodeB->global_id;
+	}
+};
+
+
+NodePool::NodePool(bool _ordered /* = false */) : ordered(_ordered), nnodes(0)
+{
+	if (!ordered) {
+		slots.assign(NODE_POOL_INITIAL_CAPACITY, NULL);
+		slot_hashes.assign(NODE_POOL_INITIAL_CAPACITY, 0);
+		mask = NODE_POOL_INITIAL_CAPACITY - 1;
+	}
+}
+
+
+void NodePool::erase(State* state)
+{
+	if (ordered) {
+		nnodes -= node_map.erase(state);
+		return;
+	}
+
+	size_t i = probe(state, state->hash());
+	if (slots[i] == NULL) {
+		return;
+	}
+	slots[i] = NULL;
+	nnodes--;
+
+	// Backward-shift deletion: move subsequent entries of the cluster into the hole if their home slot allows it
+	size_t j = i;
+	while (true) {
+		j = (j + 1) & mask;
+		if (slots[j] == NULL) {
+			break;
+		}
+		size_t home = slot_hashes[j] & mask;
+		// Entry at j can move to i only if its home slot is not cyclically in (i, j]
+		if (((j - home) & mask) >= ((j - i) & mask)) {
+			slots[i] = slots[j];
+			slot_hashes[i] = slot_hashes[j];
+			slots[j] = NULL;
+			i = j;
+		}
+	}
+}
+
+
+void NodePool::get_nodes(vector<Node*>& nodes) const
+{
+	if (ordered) {
+		for (NodeMap::const_iterator it = node_map.begin(); it != node_map.end(); ++it) {
+			nodes.push_back(it->second);
+		}
+		return;
+	}
+
+	int start = nodes.size();
+	for (Node* node : slots) {
+		if (node != NULL) {
+			nodes.push_back(node);
+		}
+	}
+	// Slot order depends on hashes; use order of creation for a canonical order
+	sort(nodes.begin() + start, nodes.end(), CompareNodesGlobalId());
+}
+
+
+void NodePool::extract_all(vector<Node*>& nodes)
+{
+	get_nodes(nodes);
+	clear();
+}
+
+
+void NodePool::clear()
+{
+	if (ordered) {
+		node_map.clear();
+	} else {
+		fill(slots.begin(), slots.end(), (Node*) NULL);
+	}
+	nnodes = 0;
+}
+
+
+void NodePool::grow()
+{
+	vector<Node*> old_slots;
+	vector<size_t> old_hashes;
+	old_slots.swap(slots);
+	old_hashes.swap(slot_hashes);
+
+	size_t capacity = 2 * old_slots.size();
+	slots.assign(capacity, NULL);
+	slot_hashes.assign(capacity, 0);
+	mask = capacity - 1;
+
+	for (size_t k = 0; k < old_slots.size(); ++k) {
+		if (old_slots[k] != NULL) {
+			size_t i = old_hashes[k] & mask;
+			while (slots[i] != NULL) {
+				i = (i + 1) & mask;
+			}
+			slots[i] = old_slots[k];
+			slot_hashes[i] = old_hashes[k];
+		}
+	}
+}
@@ -0,0 +1,157 @@
+/**
+ * Pool of nodes keyed by state, used to identify equivalent states during construction
+ */
+
+#ifndef NODE_POOL_HPP_
+#define NODE_POOL_HPP_
+
+#include <vector>
+#include <cassert>
+#include "../bdd/bdd.hpp"
+#include "../problem/state.hpp"
+
+using namespace std;
+
+#define NODE_POOL_INITIAL_CAPACITY 64
+
+
+/**
+ * Set of nodes with distinct states. By default, this is an open-addressing hash table with linear probing keyed on
+ * (State::hash, State::equals_to). If ordered, a map keyed on State::less is used instead, which is slower but
+ * reproduces the node order of the original implementation.
+ *
+ * Lookups take the type of the states as an optional template argument. With the default (State), hash and equals_to
+ * are virtual calls; with a final state class, they are resolved at compile time and use its non-virtual overloads.
+ */
+class NodePool
+{
+public:
+
+	NodePool(bool _ordered = false);
+
+	/** Return the node with a state equivalent to the given one, or NULL if none exists */
+	template<class StateT = State>
+	Node* find(State* state);
+
+	/**
+	 * Return the node with a state equivalent to that of the given node if one exists; otherwise, insert the given node
+	 * and return it.
+	 */
+	template<class StateT = State>
+	Node* find_or_insert(Node* node);
+
+	/** Insert node, assuming no node with an equivalent state exists */
+	template<class StateT = State>
+	void insert(Node* node);
+
+	/** Remove the node with a state equivalent to the given one, if any */
+	void erase(State* state);
+
+	/** Append all nodes to the given vector, in map order if ordered and in order of creation (global id) otherwise */
+	void get_nodes(vector<Node*>& nodes) const;
+
+	/** Remove all nodes from the pool and append them to the given vector (same order as get_nodes) */
+	void extract_all(vector<Node*>& nodes);
+
+	/** Remove all nodes from the pool */
+	void clear();
+
+	int size() const
+	{
+		return nnodes;
+	}
+
+	bool empty() const
+	{
+		return nnodes == 0;
+	}
+
+	bool is_ordered() const
+	{
+		return ordered;
+	}
+
+private:
+
+	bool              ordered;         /**< use ordered map instead of hash table */
+	NodeMap           node_map;        /**< ordered map (only used if ordered) */
+
+	vector<Node*>     slots;           /**< hash table slots; NULL if empty (only used if not ordered) */
+	vector<size_t>    slot_hashes;     /**< cached state hash of each slot */
+	size_t            mask;            /**< capacity - 1; capacity is a power of two */
+	int               nnodes;          /**< number of nodes in the pool */
+
+	/** Index of slot containing an equivalent state, or of the empty slot where it would be inserted */
+	template<class StateT = State>
+	size_t probe(State* state, size_t hash) const;
+
+	/** Double the capacity of the hash table */
+	void grow();
+};
+
+
+template<class StateT>
+inline size_t NodePool::probe(State* state, size_t hash) const
+{
+	size_t i = hash & mask;
+	while (slots[i] != NULL) {
+		if (slot_hashes[i] == hash && static_cast<StateT*>(slots[i]->state)->equals_to(static_cast<StateT*>(state))) {
+			return i;
+		}
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+
+template<class StateT>
+inline Node* NodePool::find(State* state)
+{
+	if (ordered) {
+		NodeMap::iterator it = node_map.find(state);
+		return (it != node_map.end()) ? it->second : NULL;
+	}
+
+	return slots[probe<StateT>(state, static_cast<StateT*>(state)->hash())];
+}
+
+
+template<class StateT>
+inline Node* NodePool::find_or_insert(Node* node)
+{
+	if (ordered) {
+		pair<NodeMap::iterator, bool> res = node_map.insert(make_pair(node->state, node));
+		if (res.second) {
+			nnodes++;
+		}
+		return res.first->second;
+	}
+
+	size_t hash = static_cast<StateT*>(node->state)->hash();
+	size_t i = probe<StateT>(node->state, hash);
+	if (slots[i] != NULL) {
+		return slots[i];
+	}
+
+	slots[i] = node;
+	slot_hashes[i] = hash;
+	nnodes++;
+
+	// Keep load factor at most 1/2
+	if (2 * (size_t) nnodes > mask + 1) {
+		grow();
+	}
+	return node;
+}
+
+
+template<class StateT>
+inline void NodePool::insert(Node* node)
+{
+	Node* inserted = find_or_insert<StateT>(node);
+	assert(inserted == node); // no equivalent state should exist
+	(void) inserted;
+}
+
+
+#endif /* NODE_POOL_HPP_ */
@@ -22,6 +22,12 @@ struct Ordering {
 	// returns vertex corresponding to particular layer
 	virtual int select_next_var(int layer) = 0;
 
+	// returns true if select_next_var does not depend on the states, so the whole ordering is known in advance
+	virtual bool is_static()
+	{
+		return false;
+	}
+
 	// Callbacks for updating structures related to ordering
 	virtual void cb_initialize() {}
 	virtual void cb_state_created(State* state) {}
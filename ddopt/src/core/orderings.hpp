@@ -35,6 +35,11 @@ struct RandomOrdering : Ordering {
 		return v_in_layer[layer];
 	}
 
+	bool is_static()
+	{
+		return true;
+	}
+
 private:
 	void construct_ordering();
 };
@@ -59,6 +64,11 @@ struct FixedOrdering : Ordering {
 		return v_in_layer[layer];
 	}
 
+	bool is_static()
+	{
+		return true;
+	}
+
 private:
 	void read_ordering(string filename);
 };
@@ -76,6 +86,11 @@ struct NoOrdering : Ordering {
 	{
 		return layer;
 	}
+
+	bool is_static()
+	{
+		return true;
+	}
 };
 
 
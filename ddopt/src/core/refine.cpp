@@ -0,0 +1,346 @@
+/**
+ * Incremental refinement of relaxed decision diagrams
+ */
+
+#include <cassert>
+#include <algorithm>
+#include <limits>
+#include "refine.hpp"
+#include "../bdd/nodedata.hpp"
+#include "../util/stats.hpp"
+
+
+int DDRefiner::refine(int max_new_nodes, double time_limit /* = -1 */)
+{
+	Stats stats;
+	stats.register_name("time_refine");
+	stats.start_timer(0);
+
+	root_layer = bdd->get_root_layer();
+	int terminal_layer = bdd->get_terminal_layer();
+
+	for (int layer = root_layer; layer <= terminal_layer; ++layer) {
+		for (Node* node : bdd->layers[layer]) {
+			if (node->state == NULL || node->data != NULL) {
+				cout << "Error: Refinement requires states in all nodes (delete_old_states off) and no node data" << endl;
+				exit(1);
+			}
+		}
+	}
+
+	// Each pass splits nodes on the longest path of the previous one, until that path has no relaxed node
+	int nadded = 0;
+	int npasses = 0;
+	update_bound();
+	bool path_relaxed = find_path_nodes();
+	while (path_relaxed && nadded < max_new_nodes) {
+		double prev_bound = bdd->bound;
+		bool timed_out = false;
+		int nadded_pass = refine_pass(max_new_nodes - nadded, stats, time_limit, timed_out);
+		nadded += nadded_pass;
+		npasses++;
+
+		update_bound();
+		path_relaxed = find_path_nodes();
+		if (timed_out || (time_limit >= 0 && stats.get_current_time(0) > time_limit)) {
+			break;
+		}
+		if (nadded_pass == 0 && !DBL_LT(bdd->bound, prev_bound)) {
+			break; // no further progress without new nodes
+		}
+	}
+	path_nodes.clear();
+	layer_states.clear();
+
+	stats.end_timer(0);
+	if (!options->quiet) {
+		cout << "Refinement: " << nadded << " nodes added in " << npasses << " passes, bound " << bdd->bound;
+		cout << (path_relaxed ? "" : " (feasible)") << ", time " << stats.get_time(0) << endl;
+	}
+
+	return nadded;
+}
+
+
+int DDRefiner::refine_pass(int max_new_nodes, Stats& stats, double time_limit, bool& timed_out)
+{
+	int terminal_layer = bdd->get_terminal_layer();
+
+	compute_exact_nodes();
+
+	// Replay layer-dependent problem data, since transitions may depend on it
+	problem->cb_initialize();
+
+	int nadded = 0;
+	int layer = root_layer;
+	for (; layer < terminal_layer; ++layer) {
+		if (time_limit >= 0 && stats.get_current_time(0) > time_limit) {
+			timed_out = true;
+			break; // nodes below keep looser states, so the DD remains a valid relaxation
+		}
+
+		int var = bdd->layer_to_var[layer];
+
+		// Split nodes present at the start of the layer; nodes split off are appended to the layer
+		if (layer > root_layer) {
+			layer_states.clear();
+			for (Node* node : bdd->layers[layer]) {
+				if (is_exact(node)) {
+					layer_states.insert(node);
+				}
+			}
+			int size = bdd->layers[layer].size();
+			for (int k = 0; k < size; ++k) {
+				Node* node = bdd->layers[layer][k];
+				if (!is_exact(node)) {
+					bool split = (path_nodes.find(node) != path_nodes.end());
+					nadded += split_node(node, max_new_nodes - nadded, split);
+				}
+			}
+		}
+
+		for (Node* node : bdd->layers[layer]) {
+			compute_outgoing_arcs(node, var);
+		}
+
+		problem->cb_layer_end(var);
+	}
+	for (; layer < terminal_layer; ++layer) {
+		problem->cb_layer_end(bdd->layer_to_var[layer]);
+	}
+	clear_pending_arcs();
+
+	return nadded;
+}
+
+
+void DDRefiner::update_bound()
+{
+	// Remove nodes that lost all their paths due to infeasible or moved arcs
+	Node* terminal = bdd->get_terminal_node();
+	if (terminal->zero_ancestors.empty() && terminal->one_ancestors.empty()) {
+		bdd->bound = -numeric_limits<double>::infinity();
+	} else {
+		bdd->remove_pathless_nodes();
+		vector<double> weights(problem->inst->weights, problem->inst->weights + problem->inst->nvars);
+		vector<int> optimal_sol;
+		bdd->bound = bdd->get_optimal_sol(weights, optimal_sol, true);
+	}
+}
+
+
+bool DDRefiner::find_path_nodes()
+{
+	// Follow the parents set by the last longest path computation (see update_bound)
+	path_nodes.clear();
+	if (bdd->bound == -numeric_limits<double>::infinity()) {
+		return false;
+	}
+	bool relaxed = false;
+	for (Node* node = bdd->get_terminal_node(); node != NULL; node = node->lp_parent) {
+		path_nodes.insert(node);
+		relaxed = relaxed || node->relaxed_node;
+	}
+	return relaxed;
+}
+
+
+void DDRefiner::compute_exact_nodes()
+{
+	int nlayers = bdd->layers.size();
+	exact.assign(nlayers, vector<char>());
+	for (int layer = 0; layer < nlayers; ++layer) {
+		exact[layer].assign(bdd->layers[layer].size(), false);
+		for (Node* node : bdd->layers[layer]) {
+			bool node_exact = !node->relaxed_node;
+			for (Node* parent : node->zero_ancestors) {
+				node_exact = node_exact && is_exact(parent);
+			}
+			for (Node* parent : node->one_ancestors) {
+				node_exact = node_exact && is_exact(parent);
+			}
+			exact[layer][node->id] = node_exact;
+		}
+	}
+}
+
+
+void DDRefiner::compute_outgoing_arcs(Node* node, int var)
+{
+	// Nodes that lost all incoming arcs are removed at the end
+	if (node->layer > root_layer && node->zero_ancestors.empty() && node->one_ancestors.empty()) {
+		return;
+	}
+
+	for (int val = 0; val <= 1; ++val) {
+		Node* child = (val == 0) ? node->zero_arc : node->one_arc;
+		if (child == NULL || is_exact(child)) {
+			continue;
+		}
+
+		State* state = node->state->transition(problem, var, val);
+		if (state == NULL) {
+			node->detach_arc(val);
+			continue;
+		}
+
+		// Long arcs: apply the skipped layers to the state
+		for (int layer = node->layer + 1; layer < child->layer; ++layer) {
+			problem->cb_skip_var_for_long_arc(bdd->layer_to_var[layer], state);
+		}
+
+		RefineArc arc;
+		arc.parent = node;
+		arc.val = val;
+		arc.state = state;
+		arc.longest_path = node->longest_path + val * problem->inst->weights[var];
+		pending_arcs[child].push_back(arc);
+	}
+}
+
+
+/** Group of incoming arcs leading to equivalent states */
+struct RefineGroup {
+	vector<int>  arcs;
+	double       longest_path;
+};
+
+
+int DDRefiner::split_node(Node* node, int max_new_nodes, bool split)
+{
+	unordered_map<Node*, vector<RefineArc>>::iterator it = pending_arcs.find(node);
+	if (it == pending_arcs.end()) {
+		return 0; // all incoming arcs were infeasible or moved; node is removed at the end
+	}
+	vector<RefineArc> arcs;
+	arcs.swap(it->second);
+	pending_arcs.erase(it);
+
+	// Group arcs by equivalent states
+	vector<RefineGroup> groups;
+	unordered_map<size_t, vector<int>> groups_by_hash;
+	for (int i = 0; i < (int) arcs.size(); ++i) {
+		vector<int>& candidates = groups_by_hash[arcs[i].state->hash()];
+		int group = -1;
+		for (int g : candidates) {
+			if (arcs[groups[g].arcs[0]].state->equals_to(arcs[i].state)) {
+				group = g;
+				break;
+			}
+		}
+		if (group == -1) {
+			group = groups.size();
+			candidates.push_back(group);
+			groups.push_back(RefineGroup());
+			groups[group].longest_path = arcs[i].longest_path;
+		}
+		groups[group].arcs.push_back(i);
+		groups[group].longest_path = MAX(groups[group].longest_path, arcs[i].longest_path);
+	}
+
+	// Groups with the state of a node already in the layer go to that node
+	int nkept = 0;
+	for (int g = 0; g < (int) groups.size(); ++g) {
+		Node* target = layer_states.find(arcs[groups[g].arcs[0]].state);
+		if (target != NULL) {
+			move_arcs(arcs, groups[g].arcs, groups[g].longest_path, target);
+		} else {
+			groups[nkept++] = groups[g];
+		}
+	}
+	groups.resize(nkept);
+	if (groups.empty()) {
+		return 0;
+	}
+
+	// Best groups are split off first
+	stable_sort(groups.begin(), groups.end(), [](const RefineGroup& a, const RefineGroup& b) {
+		return a.longest_path > b.longest_path;
+	});
+	int nsplit = split ? MIN((int) groups.size() - 1, max_new_nodes) : 0;
+
+	for (int g = 0; g < nsplit; ++g) {
+		Node* new_node = bdd->create_node(node->layer);
+		new_node->state = arcs[groups[g].arcs[0]].state;
+		new_node->longest_path = groups[g].longest_path;
+		new_node->relaxed_node = false;
+		if (node->zero_arc != NULL) {
+			new_node->assign_zero_arc(node->zero_arc);
+		}
+		if (node->one_arc != NULL) {
+			new_node->assign_one_arc(node->one_arc);
+		}
+		for (int i : groups[g].arcs) {
+			arcs[i].parent->assign_arc(new_node, arcs[i].val);
+			if (arcs[i].state != new_node->state) {
+				delete arcs[i].state;
+			}
+		}
+		layer_states.insert(new_node);
+	}
+
+	// Remaining groups stay in the node, merged if there is more than one
+	State* state = arcs[groups[nsplit].arcs[0]].state;
+	for (int g = nsplit; g < (int) groups.size(); ++g) {
+		for (int i : groups[g].arcs) {
+			if (arcs[i].state == state) {
+				continue;
+			}
+			if (g > nsplit && i == groups[g].arcs[0]) {
+				state->merge(problem, arcs[i].state);
+			}
+			delete arcs[i].state;
+			arcs[i].state = state;
+		}
+	}
+	bool merged = ((int) groups.size() - nsplit > 1);
+	double longest_path = groups[nsplit].longest_path;
+	for (int g = nsplit + 1; g < (int) groups.size(); ++g) {
+		longest_path = MAX(longest_path, groups[g].longest_path);
+	}
+
+	// The merged state may also be that of a node already in the layer
+	Node* target = layer_states.find(state);
+	if (target != NULL) {
+		vector<int> remaining;
+		for (int g = nsplit; g < (int) groups.size(); ++g) {
+			remaining.insert(remaining.end(), groups[g].arcs.begin(), groups[g].arcs.end());
+		}
+		move_arcs(arcs, remaining, longest_path, target);
+		target->relaxed_node = target->relaxed_node || merged;
+		return nsplit;
+	}
+
+	delete node->state;
+	node->state = state;
+	node->relaxed_node = merged;
+	node->longest_path = longest_path;
+	layer_states.insert(node);
+
+	return nsplit;
+}
+
+
+void DDRefiner::move_arcs(vector<RefineArc>& arcs, const vector<int>& arc_ids, double longest_path, Node* target)
+{
+	State* deleted = NULL;
+	for (int i : arc_ids) {
+		arcs[i].parent->assign_arc(target, arcs[i].val);
+		if (arcs[i].state != deleted) {
+			deleted = arcs[i].state;
+			delete deleted;
+		}
+	}
+	target->longest_path = MAX(target->longest_path, longest_path);
+}
+
+
+void DDRefiner::clear_pending_arcs()
+{
+	for (pair<Node* const, vector<RefineArc>>& entry : pending_arcs) {
+		for (RefineArc& arc : entry.second) {
+			delete arc.state;
+		}
+	}
+	pending_arcs.clear();
+}
@@ -0,0 +1,108 @@
+/**
+ * Incremental refinement of relaxed decision diagrams
+ */
+
+#ifndef REFINE_HPP_
+#define REFINE_HPP_
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "../bdd/bdd.hpp"
+#include "../problem/problem.hpp"
+#include "../util/options.hpp"
+#include "../util/stats.hpp"
+#include "node_pool.hpp"
+
+using namespace std;
+
+
+/** Incoming arc of a node being refined, with the state the arc leads to */
+struct RefineArc {
+	Node*   parent;
+	int     val;
+	State*  state;           /**< state obtained by the transition of the parent along the arc (owned by the arc) */
+	double  longest_path;    /**< longest path to the parent plus the weight of the arc */
+};
+
+
+/**
+ * Tightens a constructed relaxed DD in place instead of rebuilding it with a larger width.
+ *
+ * A node is exact if it is not relaxed and all of its parents are exact; exact nodes never change. Each pass goes
+ * through the layers top-down and recomputes the state each incoming arc of a non-exact node leads to. Arcs whose
+ * transition is infeasible are removed. The arcs of a node are then grouped by equivalent states. Groups whose state
+ * is already that of a node of the layer are moved to that node. Otherwise, if the node is on the longest path found
+ * before the pass, groups are split off into new nodes (best longest path first) while the node budget lasts; the
+ * remaining groups are merged back into the node. New nodes take the children of the node they were split from, which
+ * is valid since their states are tighter, and these arcs are filtered in turn when their layer is processed.
+ *
+ * Passes are repeated until the budget is spent or the longest path has no relaxed node, in which case the bound is
+ * that of a feasible solution.
+ *
+ * All nodes must still have their states (construction with options->delete_old_states off) and no node data. The
+ * problem may keep layer-dependent data through cb_initialize and cb_layer_end, which are replayed during the pass.
+ */
+class DDRefiner
+{
+public:
+
+	DDRefiner(Problem* _problem, BDD* _bdd, Options* _options) : problem(_problem), bdd(_bdd), options(_options),
+		layer_states(_options->ordered_node_pool) {}
+
+	/**
+	 * Run refinement passes adding at most max_new_nodes nodes and stopping after time_limit seconds (no limit if
+	 * negative). Updates the bound of the BDD and returns the number of nodes added.
+	 */
+	int refine(int max_new_nodes, double time_limit = -1);
+
+private:
+
+	Problem*                                  problem;
+	BDD*                                      bdd;
+	Options*                                  options;
+	int                                       root_layer;
+
+	vector<vector<char>>                      exact;           /**< exact[layer][id] is true if node is exact */
+	unordered_map<Node*, vector<RefineArc>>   pending_arcs;    /**< incoming arcs of non-exact nodes of later layers */
+	unordered_set<Node*>                      path_nodes;      /**< nodes on the longest path found before the pass */
+	NodePool                                  layer_states;    /**< nodes of the current layer whose states are final */
+
+	/** Mark exact nodes */
+	void compute_exact_nodes();
+
+	/** Find the nodes on a longest path of the BDD; return true if one of them is relaxed */
+	bool find_path_nodes();
+
+	/**
+	 * Run one pass adding at most max_new_nodes nodes; set timed_out if the time limit was reached during the pass.
+	 * Return the number of nodes added.
+	 */
+	int refine_pass(int max_new_nodes, Stats& stats, double time_limit, bool& timed_out);
+
+	/** Remove nodes that lost all their paths and update the bound of the BDD */
+	void update_bound();
+
+	bool is_exact(Node* node)
+	{
+		return node->id < (int) exact[node->layer].size() && exact[node->layer][node->id];
+	}
+
+	/** Compute the states along the outgoing arcs of a node that lead to non-exact nodes, removing infeasible arcs */
+	void compute_outgoing_arcs(Node* node, int var);
+
+	/**
+	 * Split the node according to the states of its incoming arcs, adding new nodes only if split is true; return the
+	 * number of nodes added
+	 */
+	int split_node(Node* node, int max_new_nodes, bool split);
+
+	/** Move the given incoming arcs to a node of the layer with the same state, deleting their states */
+	void move_arcs(vector<RefineArc>& arcs, const vector<int>& arc_ids, double longest_path, Node* target);
+
+	/** Free states of pending arcs */
+	void clear_pending_arcs();
+};
+
+
+#endif /* REFINE_HPP_ */
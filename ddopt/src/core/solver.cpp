@@ -4,9 +4,26 @@
 
 #include <cassert>
 #include "solver.hpp"
+#include "refine.hpp"
 #include "../util/util.hpp"
 #include "../util/stats.hpp"
 
+#include <limits>
+
+
+/** Average number of bytes used by the states of the given nodes */
+static size_t get_average_state_size(const vector<Node*>& nodes)
+{
+	if (nodes.empty()) {
+		return 0;
+	}
+	size_t total = 0;
+	for (Node* node : nodes) {
+		total += node->state->get_memory_size();
+	}
+	return total / nodes.size();
+}
+
 
 BDD* DDSolver::construct_decision_diagram()
 {
@@ -19,6 +36,31 @@ BDD* DDSolver::construct_decision_diagram()
 }
 
 
+BDD* DDSolver::construct_restricted_decision_diagram(int width)
+{
+	return construct_restricted_decision_diagram_at_state(problem->create_initial_state(), 0, width);
+}
+
+
+BDD* DDSolver::construct_restricted_decision_diagram_at_state(State* initial_state, double initial_longest_path, int width)
+{
+	if (problem->merger == NULL) {
+		cout << "Error: Restricted DD construction requires a merger" << endl;
+		exit(1);
+	}
+
+	int relaxed_width = problem->merger->width;
+	problem->merger->width = width;
+	restricted = true;
+
+	BDD* bdd = construct_decision_diagram_at_state(initial_state, initial_longest_path);
+
+	restricted = false;
+	problem->merger->width = relaxed_width;
+	return bdd;
+}
+
+
 BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double initial_longest_path)
 {
 	// Initialization
@@ -34,32 +76,46 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 		width = problem->merger->width;
 	}
 
-	vector<Node*> nodes_layer; // current layer
-	if (width != EXACT_BDD) {
-		nodes_layer.reserve(2 * width * 100);
-	} else {
-		nodes_layer.reserve(1e8);
+	if (options->memory_budget > 0 && problem->merger == NULL) {
+		cout << "Error: Memory budget requires a merger" << endl;
+		exit(1);
 	}
 
-	NodeMap node_list; // hash map of states to nodes
-	node_list.clear();
+	// Buffers grow with the layers and keep their capacity across layers
+	vector<Node*> nodes_layer; // current layer
+	layer_widths.assign(nlayers - 1, 0);
+	memory_estimate = 0;
+	size_t dd_bytes = 0; // bytes used by nodes already in the DD
+
+	NodePool node_list(options->ordered_node_pool); // pool of states to nodes
+	vector<Node*> pool_nodes; // nodes taken out of the pool at the start of a layer
 	int global_id = 0;
 
 	problem->callback_initialize();
 
+	// Per-layer trace; nothing below is measured if disabled
+	LayerTrace current_layer_trace;
+	chrono::steady_clock::time_point lap;
+	int trace_dd = (trace != NULL) ? trace->start_dd() : -1;
+	size_t trace_dd_state_bytes = 0; // bytes of states kept in the DD by previous layers
+
 
 	// Decision diagram construction
 
 	Node* initial_node = new Node(initial_state, initial_longest_path, initial_node_data);
-	node_list[initial_state] = initial_node;
-	problem->callback_state_created(initial_state);
 	initial_node->global_id = global_id++;
-
-	NodeMap::iterator node_it, existing_node_it;
+	node_list.insert(initial_node);
+	problem->callback_state_created(initial_state);
 
 	// iterate through layers to construct nodes
 	for (int layer = 0; layer < nlayers - 1; ++layer) {
 
+		if (trace != NULL) {
+			current_layer_trace = LayerTrace();
+			current_layer_trace.layer = layer;
+			lap = chrono::steady_clock::now();
+		}
+
 		// select next variable
 		int current_var = problem->ordering->select_next_var(layer);
 		assert(current_var >= 0 && current_var < problem->inst->nvars);
@@ -79,9 +135,11 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 		cout << "Layer " << layer << " - current variable: " << current_var << endl;
 		// iterate through the nodes in the node list
 		cout << "(Before) state list: " << endl;
-		for (NodeMap::iterator node_it = node_list.begin(); node_it != node_list.end(); ++node_it) {
-			cout << "\tstate: " << *(node_it->first);
-			cout << " - longest path: " << node_it->second->longest_path;
+		pool_nodes.clear();
+		node_list.get_nodes(pool_nodes);
+		for (Node* node : pool_nodes) {
+			cout << "\tstate: " << *(node->state);
+			cout << " - longest path: " << node->longest_path;
 			cout << endl;
 		}
 		cout << current_var << endl;
@@ -95,24 +153,23 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 		 */
 		nodes_layer.clear();
 
-		node_it = node_list.begin();
-		while (node_it != node_list.end())	{
+		// take all nodes out of the pool and put back the skipped ones, since skipping may modify their states
+		pool_nodes.clear();
+		node_list.extract_all(pool_nodes);
+		for (Node* node : pool_nodes) {
 
 			// if a node does not contain the variable, it will be skipped and corresponding arcs will be long arcs
-			if (options->use_long_arcs && problem->cb_skip_var_for_long_arc(current_var, node_it->second->state)) {
-				++node_it;
+			if (options->use_long_arcs && problem->cb_skip_var_for_long_arc(current_var, node->state)) {
+				node_list.insert(node);
 				continue;
 			}
 
 			assert((int)final_bdd->layers.size() > layer);
 
-			problem->callback_state_removed(node_it->first);
+			problem->callback_state_removed(node->state);
 
 			// add node to current layer list
-			nodes_layer.push_back(node_it->second);
-
-			// erase element from the list (erasing on-the-fly for a map)
-			node_list.erase(node_it++);
+			nodes_layer.push_back(node);
 		}
 
 #ifdef DEBUG
@@ -123,6 +180,13 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 		cout << endl;
 #endif
 
+		if (trace != NULL) {
+			current_layer_trace.var = current_var;
+			current_layer_trace.pool_size = node_list.size();
+			current_layer_trace.before_merge = nodes_layer.size();
+			current_layer_trace.time_select = trace_lap(lap);
+		}
+
 		// Print layer information
 		if (!options->quiet) {
 			cout << "Layer " << layer << " - current variable: " << current_var;
@@ -138,22 +202,44 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 		 * 2. Merging
 		 * ===============================================================================
 		 */
-		if (width != EXACT_BDD && (int) nodes_layer.size() > width) {
+		int layer_width = width;
+		size_t state_bytes = 0;
+		if (options->memory_budget > 0) {
+			state_bytes = get_average_state_size(nodes_layer);
+			layer_width = get_layer_width_for_budget(width, layer, dd_bytes, state_bytes, node_list);
+		}
+
+		if (layer_width != EXACT_BDD && (int) nodes_layer.size() > layer_width) {
 
 			if (solver_callback != NULL) {
-				solver_callback->cb_pre_merge(final_bdd, nodes_layer, node_list, width, layer);
+				solver_callback->cb_pre_merge(final_bdd, nodes_layer, node_list, layer_width, layer);
 			}
 
-			// cout << "Merging " << (int) nodes_layer.size() << " max " << width << endl;
+			// cout << "Merging " << (int) nodes_layer.size() << " max " << layer_width << endl;
 			assert(problem->merger != NULL);
-			problem->merger->merge_layer(problem, layer, nodes_layer);
+			problem->merger->width = layer_width;
+			if (restricted) {
+				problem->merger->restrict_layer(problem, layer, nodes_layer);
+			} else {
+				problem->merger->merge_layer(problem, layer, nodes_layer);
+			}
+			problem->merger->width = width;
 
 			if (solver_callback != NULL) {
-				solver_callback->cb_post_merge(final_bdd, nodes_layer, node_list, width, layer);
+				solver_callback->cb_post_merge(final_bdd, nodes_layer, node_list, layer_width, layer);
 			}
 		}
 
 		final_width = MAX(final_width, (int) nodes_layer.size());
+		layer_widths[layer] = nodes_layer.size();
+
+		if (trace != NULL) {
+			current_layer_trace.time_merge = trace_lap(lap);
+			current_layer_trace.after_merge = nodes_layer.size();
+			for (Node* node : nodes_layer) {
+				current_layer_trace.relaxed_nodes += node->relaxed_node;
+			}
+		}
 
 #ifdef DEBUG
 		cout << " - after merge: " << nodes_layer.size() << endl;
@@ -179,125 +265,52 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 		 * ===============================================================================
 		 */
 		for (Node* branch_node : nodes_layer) {
-
 			// add node to final BDD representation
 			assert(branch_node->layer == DD_NODE_ID_OPEN);
 			branch_node->layer = layer;
 			branch_node->id = final_bdd->layers[layer].size();
 			final_bdd->layers[layer].push_back(branch_node);
+		}
 
-			Node* new_node;
-
-			for (int val = 0; val <= 1; ++val) {
-
-				State* new_state = branch_node->state->transition(problem, current_var, val);
-
-				// // Debugging info
-				// cout << "[T]  Set " << current_var << " to " << val << "  /  State " << *(branch_node->state) << " / Value " << branch_node->longest_path << endl;
-				// if (new_state != NULL) {
-				//   cout << "[T]   -- Result: " << *new_state << " / Value " << branch_node->longest_path + val * problem->inst->weights[current_var] << endl;
-				// } else {
-				//   cout << "[T]   -- Result: Infeasible" << endl;
-				// }
-
-				if (new_state != NULL) {
-
-					// create new node data
-					NodeDataMap* nd = NULL;
-					if (branch_node->data != NULL) {
-						assert(!branch_node->data->is_infeasible());
-						nd = branch_node->data->transition(problem, branch_node, new_state, current_var, val);
-
-						if (nd->is_infeasible()) {
-							if (val == 1) {
-								branch_node->one_arc = NULL;
-							} else { // val == 0
-								branch_node->zero_arc = NULL;
-							}
-							continue;
-						}
-					}
-
-					// create a new (potential) node
-					new_node = new Node(new_state, branch_node->longest_path + val * problem->inst->weights[current_var], nd);
-
-					// prune node if bounds allow
-					if ((use_primal_pruning && node_can_be_pruned_by_primal_bound(problem, new_node, branch_node))) {
-						if (val == 1) {
-							branch_node->one_arc = NULL;
-						} else { // val == 0
-							branch_node->zero_arc = NULL;
-						}
-						delete new_node;
-						continue;
-					}
-
-					// check if node with this new state already exists
-					// stats.register_name("find");
-					// stats.start_timer(1);
-					existing_node_it = node_list.find(new_node->state);
-					// stats.end_timer(1);
-					// cout << "Time find: " << stats.get_time(1) << endl;
-
-					if (existing_node_it != node_list.end()) {
-						// node already exists: delete newly created node and point to existing node
-
-						Node* existing_node = existing_node_it->second;
-						existing_node->update_optimal_path(new_node);
-						if (existing_node->data != NULL) {
-							existing_node->data->merge(problem, new_node->data, new_node->state);
-						}
-						delete new_node;
-						new_node = existing_node_it->second;
-
-					} else {
-						// node does not exist: point to new node
-
-						// stats.register_name("assign");
-						// stats.start_timer(2);
-						node_list[new_node->state] = new_node;
-						// stats.end_timer(2);
-						// cout << "Time assign: " << stats.get_time(2) << endl;
-						new_node->global_id = global_id++;
-						problem->callback_state_created(new_node->state);
-					}
-
-					// update node links (either existing or new node)
-					assert(val != 1 || branch_node->one_arc == NULL);
-					assert(val != 0 || branch_node->zero_arc == NULL);
-					branch_node->assign_arc(new_node, val);
-
-					// // Debugging info
-					// cout << " (" << val << ") From " << endl;
-					// cout << "\t" << *(branch_node->state) << endl;
-					// cout << " to " << endl;
-					// cout << "\t" << *(new_node->state) << endl;
-					// cout << endl;
-				}
-			}
+		int first_new_id = global_id;
+		long npruned_before = npruned;
+		if (trace != NULL) {
+			layer_trace = &current_layer_trace;
+		}
 
-			// Optional: Delete states from previous nodes to reduce memory usage
-			if (options->delete_old_states) {
-				delete branch_node->state;
-				branch_node->state = NULL;
-			}
+		expand_layer(nodes_layer, node_list, current_var, global_id);
 
+		if (trace != NULL) {
+			layer_trace = NULL;
+			fill_layer_trace(current_layer_trace, nodes_layer, node_list, global_id - first_new_id,
+			                  npruned - npruned_before, trace_dd_state_bytes);
+			trace->write_layer(trace_dd, restricted, current_layer_trace);
 		}
 
 #ifdef DEBUG
 		// iterate through the nodes in the node list
 		cout << "(After) state list: " << endl;
-		for (NodeMap::iterator node_it = node_list.begin(); node_it != node_list.end(); ++node_it) {
-			cout << "\tstate: " << *(node_it->first);
-			cout << " - longest path: " << node_it->second->longest_path;
+		pool_nodes.clear();
+		node_list.get_nodes(pool_nodes);
+		for (Node* node : pool_nodes) {
+			cout << "\tstate: " << *(node->state);
+			cout << " - longest path: " << node->longest_path;
 			cout << endl;
 		}
 		cout << endl;
 #endif
 
+		// Account for memory: nodes of this layer stay in the DD and only keep their states if old states are not deleted;
+		// states of the next layer are assumed to be about as large as the ones of this layer
+		if (options->memory_budget > 0) {
+			size_t pool_bytes = node_list.size() * get_node_memory_size(state_bytes);
+			dd_bytes += nodes_layer.size() * get_node_memory_size(options->delete_old_states ? 0 : state_bytes);
+			memory_estimate = MAX(memory_estimate, dd_bytes + pool_bytes);
+		}
+
 		problem->cb_layer_end(current_var);
 		if (solver_callback != NULL) {
-			solver_callback->cb_layer_end(final_bdd, nodes_layer, node_list, width, layer, options);
+			solver_callback->cb_layer_end(final_bdd, nodes_layer, node_list, layer_width, layer, options);
 		}
 	}
 
@@ -322,7 +335,9 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 			cout << "Error: More than one terminal at the end of BDD construction" << endl;
 			exit(1);
 		}
-		terminal_node = node_list.begin()->second;
+		pool_nodes.clear();
+		node_list.get_nodes(pool_nodes);
+		terminal_node = pool_nodes[0];
 	}
 	node_list.clear();
 
@@ -332,6 +347,11 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 	final_bdd->layers[nlayers-1].push_back(terminal_node);
 	final_bdd->bound = terminal_node->longest_path;
 
+	// Nodes whose children were all dropped or pruned are not in any path
+	if (restricted || use_primal_pruning) {
+		final_bdd->remove_pathless_nodes();
+	}
+
 	// Final sanity checks
 #ifndef NDEBUG
 	for (int i = 0; i < nlayers; i++) {
@@ -351,16 +371,33 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 		}
 		// cout << "Layer " << i << " width: " << final_bdd->layers[i].size() << endl;
 	}
-	assert(final_bdd->layers[0].size() == 1);
+	assert(final_bdd->layers[final_bdd->get_root_layer()].size() == 1);
 	assert(final_bdd->layers[nlayers-1].size() == 1);
 	// cout << endl;
 #endif
 
+	// Refine relaxed DD in place
+	if (options->refine_nodes > 0 && !restricted) {
+		DDRefiner refiner(problem, final_bdd, options);
+		refiner.refine(options->refine_nodes, options->refine_time_limit);
+		final_width = final_bdd->get_width();
+	}
+
+	// Reduce DD; long arcs skip variables set to zero, which corresponds to the ZDD rule
+	if (options->reduce_dd) {
+		int nremoved = final_bdd->reduce(options->use_long_arcs ? REDUCE_ZDD : REDUCE_MERGE_ONLY);
+		final_width = final_bdd->get_width();
+		if (!options->quiet) {
+			cout << "Reduction removed " << nremoved << " nodes" << endl;
+		}
+	}
+
 	// Finalize construction
 	final_bdd->constructed = true;
 	if (solver_callback != NULL) {
 		solver_callback->cb_solver_end(final_bdd, options);
 	}
+	final_bdd->freeze();
 
 	stats.end_timer(0);
 	// cout << "DD construction time: " << stats.get_time(0) << endl;
@@ -369,14 +406,75 @@ BDD* DDSolver::construct_decision_diagram_at_state(State* initial_state, double
 }
 
 
-Node* DDSolver::merge_terminal_nodes(NodeMap& terminal_node_list)
+void DDSolver::fill_layer_trace(LayerTrace& t, const vector<Node*>& nodes_layer, const NodePool& node_list, int nnew_nodes,
+                                 long nlayer_pruned, size_t& dd_state_bytes)
+{
+	long narcs = 0;
+	for (Node* node : nodes_layer) {
+		narcs += (node->zero_arc != NULL) + (node->one_arc != NULL);
+		if (node->state != NULL) {
+			dd_state_bytes += node->state->get_memory_size();
+		}
+	}
+	t.transitions = 2 * nodes_layer.size();
+	t.new_nodes = nnew_nodes;
+	t.deduplicated = narcs - nnew_nodes;
+	t.pruned = nlayer_pruned;
+	t.infeasible = t.transitions - narcs - nlayer_pruned;
+
+	vector<Node*> pool_nodes;
+	node_list.get_nodes(pool_nodes);
+	t.state_bytes = dd_state_bytes;
+	for (Node* node : pool_nodes) {
+		t.state_bytes += node->state->get_memory_size();
+	}
+}
+
+
+size_t DDSolver::get_node_memory_size(size_t state_bytes) const
 {
-	NodeMap::iterator node_it = terminal_node_list.begin();
-	Node* terminal_node = node_it->second;
-	terminal_node_list.erase(node_it++);
+	// Each arc is stored as a child pointer in the parent and an ancestor pointer in the child
+	return sizeof(Node) + 2 * sizeof(Node*) + FROZEN_BDD_BYTES_PER_NODE + state_bytes;
+}
+
+
+int DDSolver::get_layer_width_for_budget(int max_width, int layer, size_t dd_bytes, size_t state_bytes,
+                                         const NodePool& node_list)
+{
+	size_t budget = (size_t) options->memory_budget * 1024 * 1024;
+
+	// Memory already committed: nodes in the DD and nodes waiting in the pool
+	size_t used_bytes = dd_bytes + node_list.size() * get_node_memory_size(state_bytes);
 
-	while (node_it != terminal_node_list.end()) {
-		Node* other = node_it->second;
+	// Each node kept in this layer stays in the DD, and the same holds for each node of the remaining layers if they end up
+	// with the same width; in addition, the next pool holds up to two live children per node
+	int nremaining_layers = nlayers - 1 - layer;
+	size_t bytes_per_unit_width = nremaining_layers * get_node_memory_size(options->delete_old_states ? 0 : state_bytes)
+	                              + 2 * get_node_memory_size(state_bytes);
+
+	size_t budget_width = (used_bytes < budget) ? (budget - used_bytes) / bytes_per_unit_width : 0;
+	int layer_width = (int) MIN(budget_width, (size_t) numeric_limits<int>::max());
+	if (max_width != EXACT_BDD) {
+		layer_width = MIN(layer_width, max_width);
+	}
+	return MAX(layer_width, 1);
+}
+
+
+void DDSolver::expand_layer(vector<Node*>& nodes_layer, NodePool& node_list, int var, int& global_id)
+{
+	expand_layer_with(problem, nodes_layer, node_list, var, global_id);
+}
+
+
+Node* DDSolver::merge_terminal_nodes(NodePool& terminal_node_list)
+{
+	vector<Node*> terminal_nodes;
+	terminal_node_list.extract_all(terminal_nodes);
+	Node* terminal_node = terminal_nodes[0];
+
+	for (int i = 1; i < (int) terminal_nodes.size(); ++i) {
+		Node* other = terminal_nodes[i];
 
 		// Update arcs
 		for (Node* parent : other->zero_ancestors) {
@@ -390,7 +488,6 @@ Node* DDSolver::merge_terminal_nodes(NodeMap& terminal_node_list)
 		if (terminal_node->data != NULL) {
 			terminal_node->data->merge(problem, other->data, other->state);
 		}
-		terminal_node_list.erase(node_it++);
 		delete other;
 	}
 
@@ -412,8 +509,14 @@ DDSolver::DDSolver(Problem* _problem, Options* _options) : problem(_problem), op
 	fill(final_bdd->layer_to_var.begin(), final_bdd->layer_to_var.end(), DD_NODE_ID_OPEN);
 	fill(final_bdd->var_to_layer.begin(), final_bdd->var_to_layer.end(), DD_NODE_ID_OPEN);
 	final_width = -1;
+	memory_estimate = 0;
 
+	restricted = false;
 	use_primal_pruning = false;
+	npruned = 0;
+
+	trace = options->trace_filename.empty() ? NULL : ConstructionTrace::open(options->trace_filename);
+	layer_trace = NULL;
 	primal_bound = -numeric_limits<double>::infinity();
 
 	initial_node_data = NULL;
@@ -429,12 +532,18 @@ void DDSolver::set_primal_bound(double bound)
 
 
 bool DDSolver::node_can_be_pruned_by_primal_bound(Problem* prob, Node* node, Node* parent)
+{
+	return node_can_be_pruned_by_primal_bound(prob, node, parent, node->longest_path);
+}
+
+
+bool DDSolver::node_can_be_pruned_by_primal_bound(Problem* prob, Node* node, Node* parent, double longest_path)
 {
 	/* prune if partial solution value + completion dual bound <= primal bound */
 	/* Note that we are always maximizing in a DD */
 	assert(prob->completion != NULL);
 	double completion_bound = prob->completion->dual_bound(prob->inst, node, parent);
-	bool pruned = DBL_LE(node->longest_path + completion_bound, primal_bound);
+	bool pruned = DBL_LE(longest_path + completion_bound, primal_bound);
 	// if (pruned) {
 	//   cout << "Pruned by primal bound: bound " << node->longest_path << " + " <<  completion_bound << " = "
 	//        << node->longest_path + completion_bound << " <= " << primal_bound << endl;
@@ -7,19 +7,33 @@
 
 #define EXACT_BDD -1
 
+#define PARALLEL_EXPANSION_MIN_NODES  256     /**< minimum layer size for multi-threaded expansion */
+#define PARALLEL_EXPANSION_CHUNK      64      /**< number of nodes a thread takes at a time during expansion */
+
+#define FROZEN_BDD_BYTES_PER_NODE     40      /**< approximate bytes per node of the FrozenBDD built at the end of construction */
+
 #include "../bdd/bdd.hpp"
 #include "../bdd/nodedata.hpp"
 #include "../problem/problem.hpp"
 #include "../problem/state.hpp"
 #include "../util/options.hpp"
+#include "../util/util.hpp"
+#include "../util/parallel.hpp"
+#include "../util/trace.hpp"
 #include "solver_callback.hpp"
+#include "node_pool.hpp"
 
 #include <vector>
 #include <map>
 #include <queue>
+#include <atomic>
 
 using namespace std;
 
+/**
+ * Decision diagram solver. Calls to states and to the problem go through virtual functions, so this works with any
+ * problem; see TypedDDSolver for a faster version for a specific problem.
+ */
 class DDSolver
 {
 public:
@@ -28,7 +42,10 @@ public:
 
 	BDD*                          final_bdd;                   /**< decision diagram */
 	int                           final_width;                 /**< final width of DD after construction */
+	vector<int>                   layer_widths;                /**< width of each layer after merging */
+	size_t                        memory_estimate;             /**< estimated peak number of bytes used by nodes, arcs and states */
 
+	bool                          restricted;                  /**< if true, nodes past the width are dropped instead of merged */
 	bool                          use_primal_pruning;          /**< if true, enables pruning with primal bound */
 	double                        primal_bound;                /**< primal bound used for pruning; only used if use_primal_pruning is true */
 
@@ -36,29 +53,439 @@ public:
 
 	DDSolverCallback*             solver_callback;             /**< special solver callback for specific situations */
 
+	ConstructionTrace*            trace;                       /**< per-layer trace (options->trace_filename); NULL if disabled */
+
 	Options*                      options;                     /**< options */
 
 	DDSolver(Problem* _problem, Options* options);
 
+	virtual ~DDSolver() {}
+
 	/** Construct a relaxed DD */
 	BDD* construct_decision_diagram();
 
 	/** Construct a relaxed DD starting at an initial state */
 	BDD* construct_decision_diagram_at_state(State* initial_state, double initial_longest_path);
 
+	/**
+	 * Construct a restricted DD of the given width, dropping nodes with Merger::restrict_layer instead of merging them.
+	 * All paths are feasible, so the bound of the DD is the value of its best solution (NULL if none was found).
+	 */
+	BDD* construct_restricted_decision_diagram(int width);
+
+	/** Construct a restricted DD of the given width starting at an initial state */
+	BDD* construct_restricted_decision_diagram_at_state(State* initial_state, double initial_longest_path, int width);
+
 	/** Set a primal bound for possible pruning */
 	void set_primal_bound(double bound);
 
 	/** Check if node can be pruned due to the primal bound */
 	bool node_can_be_pruned_by_primal_bound(Problem* prob, Node* node, Node* parent);
 
+	/** Same as above for a path of the given value to a node with the state of the given node */
+	bool node_can_be_pruned_by_primal_bound(Problem* prob, Node* node, Node* parent, double longest_path);
+
 	/** Add NodeData to root node (key is used to recover this node_data) */
 	void add_initial_node_data(string key, NodeData* node_data);
 
+protected:
+
+	LayerTrace*                   layer_trace;                 /**< trace of the layer being expanded; NULL if not tracing */
+	atomic<long>                  npruned;                     /**< number of children pruned by the primal bound */
+
+	/** Create children of all nodes in the layer and add them to the node pool, merging equivalent ones */
+	virtual void expand_layer(vector<Node*>& nodes_layer, NodePool& node_list, int var, int& global_id);
+
+	/**
+	 * Implementation of expand_layer for a problem of type ProblemT with states of type ProblemT::StateType. Transitions,
+	 * hashes and equivalence checks are resolved at compile time for that type. Uses options->nthreads threads if the
+	 * layer is large enough; the resulting DD does not depend on the number of threads.
+	 */
+	template<class ProblemT>
+	void expand_layer_with(ProblemT* prob, vector<Node*>& nodes_layer, NodePool& node_list, int var, int& global_id);
+
+	/**
+	 * Create the child of a node with var set to val, including its node data.
+	 * Return NULL if the transition is infeasible or the child is pruned by the primal bound.
+	 */
+	template<class ProblemT>
+	Node* create_child(ProblemT* prob, Node* branch_node, int var, int val);
+
+	/** Create the child of a node from its state, as create_child; the child takes ownership of new_state */
+	template<class ProblemT>
+	Node* create_child_from_state(ProblemT* prob, Node* branch_node, int var, int val, State* new_state);
+
+	/**
+	 * Two-phase version of create_child for problems with probe_transitions and nodes without node data. The child
+	 * state is computed into scratch and looked up in the pool first. If an equivalent node exists, return NULL and set
+	 * existing_node to it, or to NULL if the child is pruned; the caller must update its longest path. Otherwise, return
+	 * a new node as create_child does. The pool is only read. If lap is given, time up to the lookup is recorded in the
+	 * layer trace as transition time and the lookup itself as probe time.
+	 */
+	template<class ProblemT>
+	Node* probe_child(ProblemT* prob, Node* branch_node, int var, int val, typename ProblemT::StateType* scratch,
+	                  NodePool& node_list, Node*& existing_node, chrono::steady_clock::time_point* lap = NULL);
+
+	/** Single-threaded expansion of a layer; if Traced, time spent in transitions and pool probes is recorded */
+	template<class ProblemT, bool Traced>
+	void expand_layer_sequential(ProblemT* prob, vector<Node*>& nodes_layer, NodePool& node_list, int var, int& global_id);
+
+	/** Multi-threaded expansion of a layer, yielding the same DD as expand_layer_sequential */
+	template<class ProblemT>
+	void expand_layer_parallel(ProblemT* prob, vector<Node*>& nodes_layer, NodePool& node_list, int var, int& global_id);
+
 private:
 
+	/**
+	 * Largest width for the layer being merged such that the projected footprint of the DD stays within
+	 * options->memory_budget, assuming all remaining layers have the same width. dd_bytes is the number of bytes used by
+	 * nodes already in the DD and state_bytes the average size of a state in the layer. Never larger than max_width unless max_width is EXACT_BDD, and never smaller than one.
+	 */
+	int get_layer_width_for_budget(int max_width, int layer, size_t dd_bytes, size_t state_bytes, const NodePool& node_list);
+
+	/**
+	 * Fill in the counts of the layer trace after expansion. States still held by nodes of the layer are added to
+	 * dd_state_bytes, which accumulates the bytes of states kept in the DD.
+	 */
+	void fill_layer_trace(LayerTrace& t, const vector<Node*>& nodes_layer, const NodePool& node_list, int nnew_nodes,
+	                       long nlayer_pruned, size_t& dd_state_bytes);
+
+	/** Approximate bytes used by a node, its incoming arcs and, if given, its state */
+	size_t get_node_memory_size(size_t state_bytes) const;
+
 	/** Merge terminal nodes if there is more than one at the end */
-	Node* merge_terminal_nodes(NodeMap& terminal_node_list);
+	Node* merge_terminal_nodes(NodePool& terminal_node_list);
 };
 
+
+/**
+ * Decision diagram solver for a specific problem type. ProblemT must define StateType as the (final) class of its
+ * states, with non-virtual overloads transition(ProblemT*, int, int) and equals_to(StateType*). Layer expansion then
+ * calls these directly instead of going through virtual functions and casts; the resulting DD is the same as with
+ * DDSolver.
+ */
+template<class ProblemT>
+class TypedDDSolver : public DDSolver
+{
+public:
+	ProblemT*                     typed_problem;               /**< problem with its actual type */
+
+	TypedDDSolver(ProblemT* _problem, Options* _options) : DDSolver(_problem, _options), typed_problem(_problem) {}
+
+protected:
+
+	void expand_layer(vector<Node*>& nodes_layer, NodePool& node_list, int var, int& global_id)
+	{
+		expand_layer_with(typed_problem, nodes_layer, node_list, var, global_id);
+	}
+};
+
+
+template<class ProblemT>
+inline Node* DDSolver::create_child(ProblemT* prob, Node* branch_node, int var, int val)
+{
+	typedef typename ProblemT::StateType StateT;
+
+	State* new_state = static_cast<StateT*>(branch_node->state)->transition(prob, var, val);
+	return create_child_from_state(prob, branch_node, var, val, new_state);
+}
+
+
+template<class ProblemT>
+inline Node* DDSolver::create_child_from_state(ProblemT* prob, Node* branch_node, int var, int val, State* new_state)
+{
+
+	// // Debugging info
+	// cout << "[T]  Set " << var << " to " << val << "  /  State " << *(branch_node->state) << " / Value " << branch_node->longest_path << endl;
+	// if (new_state != NULL) {
+	//   cout << "[T]   -- Result: " << *new_state << " / Value " << branch_node->longest_path + val * problem->inst->weights[var] << endl;
+	// } else {
+	//   cout << "[T]   -- Result: Infeasible" << endl;
+	// }
+
+	if (new_state == NULL) {
+		return NULL;
+	}
+
+	// create new node data
+	NodeDataMap* nd = NULL;
+	if (branch_node->data != NULL) {
+		assert(!branch_node->data->is_infeasible());
+		nd = branch_node->data->transition(problem, branch_node, new_state, var, val);
+
+		if (nd->is_infeasible()) {
+			delete nd;
+			delete new_state;
+			return NULL;
+		}
+	}
+
+	// create a new (potential) node
+	Node* new_node = new Node(new_state, branch_node->longest_path + val * problem->inst->weights[var], nd);
+
+	// prune node if bounds allow
+	if ((use_primal_pruning && node_can_be_pruned_by_primal_bound(problem, new_node, branch_node))) {
+		npruned++;
+		delete new_node;
+		return NULL;
+	}
+
+	return new_node;
+}
+
+
+template<class ProblemT>
+inline Node* DDSolver::probe_child(ProblemT* prob, Node* branch_node, int var, int val,
+                                   typename ProblemT::StateType* scratch, NodePool& node_list, Node*& existing_node,
+                                   chrono::steady_clock::time_point* lap)
+{
+	typedef typename ProblemT::StateType StateT;
+	assert(branch_node->data == NULL);
+
+	existing_node = NULL;
+	if (!static_cast<StateT*>(branch_node->state)->transition_into(prob, var, val, scratch)) {
+		return NULL;
+	}
+
+	if (lap != NULL) {
+		layer_trace->time_transitions += trace_lap(*lap);
+	}
+	Node* found_node = node_list.find<StateT>(scratch);
+	if (lap != NULL) {
+		layer_trace->time_probes += trace_lap(*lap);
+	}
+	if (found_node == NULL) {
+		return create_child_from_state(prob, branch_node, var, val, scratch->clone());
+	}
+
+	// The completion bound of the child is that of the equivalent node, as it only depends on the state
+	double longest_path = branch_node->longest_path + val * problem->inst->weights[var];
+	if (use_primal_pruning && node_can_be_pruned_by_primal_bound(problem, found_node, branch_node, longest_path)) {
+		npruned++;
+		return NULL;
+	}
+	existing_node = found_node;
+	return NULL;
+}
+
+
+/** Absorb a newly created node into an existing node with an equivalent state and delete the new node */
+inline void absorb_equivalent_node(Problem* problem, Node* existing_node, Node* new_node)
+{
+	existing_node->update_optimal_path(new_node);
+	if (existing_node->data != NULL) {
+		existing_node->data->merge(problem, new_node->data, new_node->state);
+	}
+	delete new_node;
+}
+
+
+template<class ProblemT>
+inline void DDSolver::expand_layer_with(ProblemT* prob, vector<Node*>& nodes_layer, NodePool& node_list, int var,
+                                        int& global_id)
+{
+	if (options->nthreads > 1 && (int) nodes_layer.size() >= PARALLEL_EXPANSION_MIN_NODES) {
+		expand_layer_parallel(prob, nodes_layer, node_list, var, global_id);
+	} else if (layer_trace != NULL) {
+		expand_layer_sequential<ProblemT, true>(prob, nodes_layer, node_list, var, global_id);
+	} else {
+		expand_layer_sequential<ProblemT, false>(prob, nodes_layer, node_list, var, global_id);
+	}
+}
+
+
+template<class ProblemT, bool Traced>
+inline void DDSolver::expand_layer_sequential(ProblemT* prob, vector<Node*>& nodes_layer, NodePool& node_list, int var,
+                                              int& global_id)
+{
+	typedef typename ProblemT::StateType StateT;
+
+	chrono::steady_clock::time_point lap;
+	if (Traced) {
+		lap = chrono::steady_clock::now();
+	}
+
+	StateT* scratch = NULL;
+	if (ProblemT::probe_transitions && !nodes_layer.empty()) {
+		scratch = static_cast<StateT*>(nodes_layer[0]->state->clone());
+	}
+
+	for (Node* branch_node : nodes_layer) {
+		for (int val = 0; val <= 1; ++val) {
+
+			Node* new_node;
+			Node* probed_node = NULL;
+			if (scratch != NULL && branch_node->data == NULL) {
+				new_node = probe_child(prob, branch_node, var, val, scratch, node_list, probed_node,
+				                       Traced ? &lap : NULL);
+			} else {
+				new_node = create_child(prob, branch_node, var, val);
+			}
+			if (Traced) {
+				layer_trace->time_transitions += trace_lap(lap);
+			}
+
+			// equivalent node found without creating the child
+			if (probed_node != NULL) {
+				probed_node->update_optimal_path(branch_node->longest_path + val * problem->inst->weights[var]);
+				branch_node->assign_arc(probed_node, val);
+				if (Traced) {
+					layer_trace->time_probes += trace_lap(lap);
+				}
+				continue;
+			}
+
+			if (new_node == NULL) {
+				continue;
+			}
+
+			// check if node with this new state already exists, inserting it otherwise
+			Node* existing_node = node_list.find_or_insert<StateT>(new_node);
+
+			if (existing_node != new_node) {
+				// node already exists: delete newly created node and point to existing node
+				absorb_equivalent_node(problem, existing_node, new_node);
+				new_node = existing_node;
+
+			} else {
+				// node does not exist: new node was inserted into the pool
+				new_node->global_id = global_id++;
+				problem->callback_state_created(new_node->state);
+			}
+
+			// update node links (either existing or new node)
+			assert(val != 1 || branch_node->one_arc == NULL);
+			assert(val != 0 || branch_node->zero_arc == NULL);
+			branch_node->assign_arc(new_node, val);
+			if (Traced) {
+				layer_trace->time_probes += trace_lap(lap);
+			}
+		}
+
+		// Optional: Delete states from previous nodes to reduce memory usage
+		if (options->delete_old_states) {
+			delete branch_node->state;
+			branch_node->state = NULL;
+		}
+	}
+
+	delete scratch;
+}
+
+
+template<class ProblemT>
+inline void DDSolver::expand_layer_parallel(ProblemT* prob, vector<Node*>& nodes_layer, NodePool& node_list, int var,
+                                            int& global_id)
+{
+	typedef typename ProblemT::StateType StateT;
+
+	int nthreads = options->nthreads;
+	int nnodes = nodes_layer.size();
+
+	// Child of nodes_layer[i] with value val is stored at index 2*i + val (NULL if infeasible or pruned). Children found
+	// in the pool by probing (is_existing) are nodes of previous layers, whose longest path is updated in phase 3.
+	vector<Node*> children(2 * nnodes, NULL);
+	vector<char> is_new(2 * nnodes, false);
+	vector<char> is_existing(2 * nnodes, false);
+
+	// One scratch state per thread for probing
+	vector<StateT*> scratch(nthreads, NULL);
+	if (ProblemT::probe_transitions) {
+		for (int t = 0; t < nthreads; ++t) {
+			scratch[t] = static_cast<StateT*>(nodes_layer[0]->state->clone());
+		}
+	}
+
+	chrono::steady_clock::time_point lap;
+	if (layer_trace != NULL) {
+		lap = chrono::steady_clock::now();
+	}
+
+	// Phase 1: transitions, with chunks of branch nodes taken dynamically by threads
+	atomic<int> next_chunk(0);
+	run_in_parallel(nthreads, [&](int t) {
+		int start;
+		while ((start = next_chunk.fetch_add(PARALLEL_EXPANSION_CHUNK)) < nnodes) {
+			int end = MIN(start + PARALLEL_EXPANSION_CHUNK, nnodes);
+			for (int i = start; i < end; ++i) {
+				Node* branch_node = nodes_layer[i];
+				for (int val = 0; val <= 1; ++val) {
+					if (scratch[t] != NULL && branch_node->data == NULL) {
+						Node* existing_node;
+						children[2 * i + val] = probe_child(prob, branch_node, var, val, scratch[t], node_list,
+						                                    existing_node);
+						if (existing_node != NULL) {
+							children[2 * i + val] = existing_node;
+							is_existing[2 * i + val] = true;
+						}
+					} else {
+						children[2 * i + val] = create_child(prob, branch_node, var, val);
+					}
+				}
+				if (options->delete_old_states) {
+					delete branch_node->state;
+					branch_node->state = NULL;
+				}
+			}
+		}
+	});
+
+	if (layer_trace != NULL) {
+		layer_trace->time_transitions += trace_lap(lap);
+	}
+
+	// Phase 2: identify equivalent states. Children are partitioned into shards by hash, so that equivalent states land
+	// in the same shard, and each thread deduplicates one shard in order of children. The pool is only read here.
+	vector<vector<int>> shard_children(nthreads);
+	for (int c = 0; c < 2 * nnodes; ++c) {
+		if (children[c] != NULL && !is_existing[c]) {
+			size_t hash = static_cast<StateT*>(children[c]->state)->hash();
+			shard_children[(hash >> (4 * sizeof(size_t))) % nthreads].push_back(c);
+		}
+	}
+	run_in_parallel(nthreads, [&](int t) {
+		NodePool shard_pool(node_list.is_ordered()); // nodes created in this layer that fall into this shard
+		for (int c : shard_children[t]) {
+			Node* new_node = children[c];
+			Node* existing_node = node_list.find<StateT>(new_node->state);
+			if (existing_node == NULL) {
+				existing_node = shard_pool.find_or_insert<StateT>(new_node);
+			}
+			if (existing_node != new_node) {
+				absorb_equivalent_node(problem, existing_node, new_node);
+				children[c] = existing_node;
+			} else {
+				is_new[c] = true;
+			}
+		}
+	});
+
+	// Phase 3: insert new nodes and wire arcs sequentially in order of children, yielding the same ids, arcs and callback
+	// order as the single-threaded expansion
+	for (int c = 0; c < 2 * nnodes; ++c) {
+		Node* child = children[c];
+		if (child == NULL) {
+			continue;
+		}
+		if (is_new[c]) {
+			child->global_id = global_id++;
+			node_list.insert<StateT>(child);
+			problem->callback_state_created(child->state);
+		} else if (is_existing[c]) {
+			Node* branch_node = nodes_layer[c / 2];
+			child->update_optimal_path(branch_node->longest_path + (c % 2) * problem->inst->weights[var]);
+		}
+		nodes_layer[c / 2]->assign_arc(child, c % 2);
+	}
+
+	for (StateT* scratch_state : scratch) {
+		delete scratch_state;
+	}
+
+	if (layer_trace != NULL) {
+		layer_trace->time_probes += trace_lap(lap);
+	}
+}
+
+
 #endif /* SOLVER_HPP_ */
@@ -7,6 +7,7 @@
 
 #include "../bdd/bdd.hpp"
 #include "../util/options.hpp"
+#include "node_pool.hpp"
 
 /** Interface for a special callback to be called during DD construction */
 class DDSolverCallback
@@ -14,12 +15,12 @@ class DDSolverCallback
 public:
 	virtual ~DDSolverCallback() {}
 
-	virtual void cb_layer_end(BDD* bdd, const vector<Node*>& nodes_layer, NodeMap& node_list, int width, int current_layer,
+	virtual void cb_layer_end(BDD* bdd, const vector<Node*>& nodes_layer, NodePool& node_list, int width, int current_layer,
 	                          Options* options) {}
 
-	virtual void cb_pre_merge(BDD* bdd, const vector<Node*>& nodes_layer, const NodeMap& node_list, int width, int current_layer) {}
+	virtual void cb_pre_merge(BDD* bdd, const vector<Node*>& nodes_layer, const NodePool& node_list, int width, int current_layer) {}
 
-	virtual void cb_post_merge(BDD* bdd, const vector<Node*>& nodes_layer, const NodeMap& node_list, int width, int current_layer) {}
+	virtual void cb_post_merge(BDD* bdd, const vector<Node*>& nodes_layer, const NodePool& node_list, int width, int current_layer) {}
 
 	virtual void cb_solver_end(BDD* bdd, Options* options) {}
 };
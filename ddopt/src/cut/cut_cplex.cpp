@@ -68,24 +68,30 @@ Inequality* generate_bdd_inequality(BDD* bdd, const vector<double>& x, const vec
 			one_arc_constrs[i] = IloRangeArray(env, size);
 		}
 
-		// Add constraints
+		// Add constraints (arcs are read from the frozen representation of the BDD)
+		if (bdd->frozen == NULL) {
+			bdd->freeze();
+		}
+		const FrozenBDD* fbdd = bdd->frozen;
 		for (int i = 0; i < nvars; ++i) {
-			int size = bdd->layers[i].size();
-			for (int j = 0; j < size; ++j) {
-				Node* zero_node = bdd->layers[i][j]->zero_arc;
-				Node* one_node = bdd->layers[i][j]->one_arc;
-
-				if (zero_node != NULL) {
-					// cout << i << "," << j << " / " << zero_node->layer << "," << zero_node->id << endl;
-					// model.add( v[zero_node->layer][zero_node->id] <= v[i][j] );
-					zero_arc_constrs[i][j] = IloRange(env, v[zero_node->layer][zero_node->id] - v[i][j], 0,
+			for (int idx = fbdd->layer_offset[i]; idx < fbdd->layer_offset[i+1]; ++idx) {
+				int j = idx - fbdd->layer_offset[i];
+				int zero_node = fbdd->zero_child[idx];
+				int one_node = fbdd->one_child[idx];
+
+				if (zero_node != FROZEN_NO_NODE) {
+					int zero_layer = fbdd->node_layer[zero_node];
+					int zero_id = zero_node - fbdd->layer_offset[zero_layer];
+					// model.add( v[zero_layer][zero_id] <= v[i][j] );
+					zero_arc_constrs[i][j] = IloRange(env, v[zero_layer][zero_id] - v[i][j], 0,
 					                                  ("a0_" + to_string(i) + "," + to_string(j)).c_str());
 					model.add(zero_arc_constrs[i][j]);
 				}
-				if (one_node != NULL) {
-					// cout << i << "," << j << " / " << one_node->layer << "," << one_node->id << endl;
-					// model.add( v[one_node->layer][one_node->id] <= v[i][j] - u[i] );
-					one_arc_constrs[i][j] = IloRange(env, v[one_node->layer][one_node->id] - v[i][j] + u[i], 0,
+				if (one_node != FROZEN_NO_NODE) {
+					int one_layer = fbdd->node_layer[one_node];
+					int one_id = one_node - fbdd->layer_offset[one_layer];
+					// model.add( v[one_layer][one_id] <= v[i][j] - u[i] );
+					one_arc_constrs[i][j] = IloRange(env, v[one_layer][one_id] - v[i][j] + u[i], 0,
 					                                 ("a1_" + to_string(i) + "," + to_string(j)).c_str());
 					model.add(one_arc_constrs[i][j]);
 				}
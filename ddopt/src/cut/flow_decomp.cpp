@@ -113,6 +113,10 @@ double extract_lexmin_path_from_flow(BDD* bdd, const vector<vector<double>>& zer
 double extract_optimal_path_from_flow(BDD* bdd, const vector<double>& weights, const vector<vector<double>>& zero_arc_flow,
                                       const vector<vector<double>>& one_arc_flow, vector<int>& optimal_path)
 {
+	if (bdd->frozen != NULL) {
+		return extract_optimal_path_from_flow(bdd->frozen, weights, zero_arc_flow, one_arc_flow, optimal_path);
+	}
+
 	int bdd_size = bdd->layers.size();
 
 	assert(bdd->layers.size() > 0);
@@ -192,6 +196,72 @@ double extract_optimal_path_from_flow(BDD* bdd, const vector<double>& weights, c
 }
 
 
+double extract_optimal_path_from_flow(const FrozenBDD* fbdd, const vector<double>& weights,
+                                      const vector<vector<double>>& zero_arc_flow, const vector<vector<double>>& one_arc_flow,
+                                      vector<int>& optimal_path)
+{
+	int nnodes = fbdd->nnodes;
+
+	assert((int) weights.size() == fbdd->nlayers - 1);
+
+	vector<double> value(nnodes, -numeric_limits<double>::infinity());
+	vector<int32_t> best_arc(nnodes, FROZEN_NO_NODE); // encoded as in parent_arcs
+	value[fbdd->root] = 0;
+
+	// Pull values through parent arcs with positive flow, in the same tie-breaking order as pushing values to children
+	for (int i = fbdd->root + 1; i < nnodes; ++i) {
+		for (int a = fbdd->parent_offset[i]; a < fbdd->parent_offset[i + 1]; ++a) {
+			int32_t parent_arc = fbdd->parent_arcs[a];
+			int parent = parent_arc >> 1;
+			int layer = fbdd->node_layer[parent];
+			int id = parent - fbdd->layer_offset[layer];
+			double val = value[parent];
+			if (parent_arc & 1) {
+				if (!DBL_GT_TOL(one_arc_flow[layer][id], 0, OPT_TOL)) {
+					continue;
+				}
+				val += weights[layer];
+			} else if (!DBL_GT_TOL(zero_arc_flow[layer][id], 0, OPT_TOL)) {
+				continue;
+			}
+			if (val > value[i]) {
+				value[i] = val;
+				best_arc[i] = parent_arc;
+			}
+		}
+	}
+
+	// Extract optimal path
+	int node = fbdd->terminal;
+
+	if (best_arc[node] == FROZEN_NO_NODE) {
+		// Terminal node was unreachable due to pruning + skipping relaxed nodes
+		optimal_path.resize(0);
+		return 0;
+	}
+
+	optimal_path.assign(fbdd->nlayers - 1, 0);
+	double path_flow_val = numeric_limits<double>::infinity();
+
+	while (best_arc[node] != FROZEN_NO_NODE) {
+		int parent = best_arc[node] >> 1;
+		int arc_val = best_arc[node] & 1;
+		int layer = fbdd->node_layer[parent];
+		int id = parent - fbdd->layer_offset[layer];
+		double flow_val = (arc_val == 0) ? zero_arc_flow[layer][id] : one_arc_flow[layer][id];
+		if (DBL_LT_TOL(flow_val, path_flow_val, OPT_TOL)) {
+			path_flow_val = flow_val;
+		}
+
+		optimal_path[layer] = arc_val;
+		node = parent;
+	}
+	assert(node == fbdd->root);
+
+	return path_flow_val;
+}
+
+
 void remove_path_from_flow(BDD* bdd, vector<vector<double>>& zero_arc_flow, vector<vector<double>>& one_arc_flow,
                            const vector<int>& path, double path_weight)
 {
@@ -44,6 +44,11 @@ double extract_lexmin_path_from_flow(BDD* bdd, const vector<vector<double>>& zer
 double extract_optimal_path_from_flow(BDD* bdd, const vector<double>& weights, const vector<vector<double>>& zero_arc_flow,
                                       const vector<vector<double>>& one_arc_flow, vector<int>& optimal_path);
 
+/** Same as extract_optimal_path_from_flow, over a frozen BDD */
+double extract_optimal_path_from_flow(const FrozenBDD* fbdd, const vector<double>& weights,
+                                      const vector<vector<double>>& zero_arc_flow, const vector<vector<double>>& one_arc_flow,
+                                      vector<int>& optimal_path);
+
 /** Remove a given feasible path from flow vectors */
 void remove_path_from_flow(BDD* bdd, vector<vector<double>>& zero_arc_flow, vector<vector<double>>& one_arc_flow,
                            const vector<int>& path, double path_weight);
@@ -20,12 +20,21 @@ int main(int argc, char* argv[])
 
 		cout << "Execution options:\n";
 		cout << "    --dd-only                 do not run the IP solver\n";
+		cout << "    --bnb                     solve with DD-based branch-and-bound instead of the IP solver\n";
 		cout << endl;
 
 		cout << "Decision diagram construction options:\n";
 		cout << "    -m [id]                   merging scheme (see documentation for ids)\n";
 		cout << "    -o [id]                   variable ordering (see documentation for ids)\n";
 		cout << "    -w [width]                maximum decision diagram width (default: no limit)\n";
+		cout << "    --threads [n]             number of threads for decision diagram construction (default: 1)\n";
+		cout << "    --memory-budget [MB]      choose the width of each layer to fit a memory budget\n";
+		cout << "    --reduce                  reduce the decision diagram after construction\n";
+		cout << "    --refine [n]              refine the relaxed decision diagram by adding up to n nodes\n";
+		cout << "    --restricted-width [w]    build a restricted decision diagram first and prune with its solution (with --dd-only)\n";
+		cout << "    --prop-budget [n]         maximum number of rows scanned per domain propagation (default: until fixpoint)\n";
+		cout << "    --no-setcover             solve set covering instances as general binary programs\n";
+		cout << "    --trace [file]            write a per-layer construction trace (timings, transition counts, state memory) as JSON Lines\n";
 		cout << endl;
 
 		cout << "Decision diagram cut options:\n";
@@ -73,6 +82,19 @@ int main(int argc, char* argv[])
 #define OPT_CUT_INTPT         16
 #define OPT_SKIP_DD           17
 #define OPT_ROOT_LP           18
+#define OPT_ORDERED_POOL      19
+#define OPT_THREADS           20
+#define OPT_MEMORY_BUDGET     21
+#define OPT_REDUCE            22
+#define OPT_REFINE            23
+#define OPT_REFINE_TIME       24
+#define OPT_RESTRICTED_WIDTH  25
+#define OPT_BNB               26
+#define OPT_BNB_THREADS       27
+#define OPT_BNB_TIME          28
+#define OPT_TRACE             29
+#define OPT_PROP_BUDGET       30
+#define OPT_NO_SETCOVER       31
 		{"merger",                 required_argument, 0, 'm'},
 		{"ordering",               required_argument, 0, 'o'},
 		{"width",                  required_argument, 0, 'w'},
@@ -95,6 +117,19 @@ int main(int argc, char* argv[])
 		{"cut-intpt",              required_argument, 0, OPT_CUT_INTPT},
 		{"skip-dd",                no_argument,       0, OPT_SKIP_DD},
 		{"root-lp",                required_argument, 0, OPT_ROOT_LP},
+		{"ordered-pool",           no_argument,       0, OPT_ORDERED_POOL},
+		{"threads",                required_argument, 0, OPT_THREADS},
+		{"memory-budget",          required_argument, 0, OPT_MEMORY_BUDGET},
+		{"reduce",                 no_argument,       0, OPT_REDUCE},
+		{"refine",                 required_argument, 0, OPT_REFINE},
+		{"refine-time",            required_argument, 0, OPT_REFINE_TIME},
+		{"restricted-width",       required_argument, 0, OPT_RESTRICTED_WIDTH},
+		{"bnb",                    no_argument,       0, OPT_BNB},
+		{"bnb-threads",            required_argument, 0, OPT_BNB_THREADS},
+		{"bnb-time",               required_argument, 0, OPT_BNB_TIME},
+		{"trace",                  required_argument, 0, OPT_TRACE},
+		{"prop-budget",            required_argument, 0, OPT_PROP_BUDGET},
+		{"no-setcover",            no_argument,       0, OPT_NO_SETCOVER},
 		{0, 0, 0, 0}
 	};
 
@@ -192,6 +227,70 @@ int main(int argc, char* argv[])
 				exit(1);
 			}
 			break;
+		case OPT_ORDERED_POOL:
+			options.ordered_node_pool = true;
+			break;
+		case OPT_THREADS:
+			options.nthreads = atoi(optarg);
+			if (options.nthreads < 1) {
+				cout << "Error: Invalid parameter - number of threads" << endl;
+				exit(1);
+			}
+			break;
+		case OPT_MEMORY_BUDGET:
+			options.memory_budget = atoi(optarg);
+			if (options.memory_budget < 1) {
+				cout << "Error: Invalid parameter - memory budget" << endl;
+				exit(1);
+			}
+			break;
+		case OPT_REDUCE:
+			options.reduce_dd = true;
+			break;
+		case OPT_REFINE:
+			options.refine_nodes = atoi(optarg);
+			if (options.refine_nodes < 0) {
+				cout << "Error: Invalid parameter - number of refinement nodes" << endl;
+				exit(1);
+			}
+			options.delete_old_states = false; // refinement recomputes transitions from the states of all nodes
+			break;
+		case OPT_REFINE_TIME:
+			options.refine_time_limit = atof(optarg);
+			break;
+		case OPT_RESTRICTED_WIDTH:
+			options.restricted_width = atoi(optarg);
+			if (options.restricted_width < 1) {
+				cout << "Error: Invalid parameter - restricted width" << endl;
+				exit(1);
+			}
+			break;
+		case OPT_BNB:
+			options.bnb = true;
+			break;
+		case OPT_BNB_THREADS:
+			options.bnb_threads = atoi(optarg);
+			if (options.bnb_threads < 1) {
+				cout << "Error: Invalid parameter - number of branch-and-bound threads" << endl;
+				exit(1);
+			}
+			break;
+		case OPT_BNB_TIME:
+			options.bnb_time_limit = atof(optarg);
+			break;
+		case OPT_TRACE:
+			options.trace_filename = optarg;
+			break;
+		case OPT_PROP_BUDGET:
+			options.bp_prop_budget = atoi(optarg);
+			if (options.bp_prop_budget < 1) {
+				cout << "Error: Invalid parameter - propagation budget" << endl;
+				exit(1);
+			}
+			break;
+		case OPT_NO_SETCOVER:
+			options.bp_setcover_state = false;
+			break;
 		default:
 			exit(1);
 		}
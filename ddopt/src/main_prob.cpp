@@ -5,6 +5,7 @@
 #include "main_prob.hpp"
 
 #include "core/solver.hpp"
+#include "core/branch_bound.hpp"
 #include "core/orderings.hpp"
 #include "core/mergers.hpp"
 #include "util/stats.hpp"
@@ -19,6 +20,7 @@
 #include "problem/indepset/indepset_problem.hpp"
 #include "problem/indepset/indepset_mergers.hpp"
 #include "problem/indepset/indepset_orderings.hpp"
+#include "problem/indepset/indepset_completion.hpp"
 #ifdef SOLVER_CPLEX
 #include "problem/indepset/indepset_model_cplex.hpp"
 #endif
@@ -29,16 +31,131 @@
 #include "problem/bp/bp_mergers.hpp"
 #include "problem/bp/bp_orderings.hpp"
 #include "problem/bp/prop_linearcons.hpp"
+#include "problem/bp/bp_completion.hpp"
+#include "problem/bp/bp_reader_mps.hpp"
 #ifdef SOLVER_CPLEX
-#include "problem/bp/bp_reader_cplex.hpp"
 #include "problem/bp/bp_model_cplex.hpp"
 #endif
 
+// Set covering headers
+#include "problem/setcover/setcover_problem.hpp"
+#include "problem/setcover/setcover_mergers.hpp"
+#include "problem/setcover/setcover_orderings.hpp"
+#include "problem/setcover/setcover_completion.hpp"
+
 #define DEFAULT_INDEPSET_ORDERING 8
 #define DEFAULT_INDEPSET_MERGING 1
 #define DEFAULT_BP_ORDERING 4
 #define DEFAULT_BP_MERGING 1
+#define DEFAULT_SETCOVER_ORDERING 4
+#define DEFAULT_SETCOVER_MERGING 1
+
+
+
+/** Print the width of each layer chosen under a memory budget */
+static void print_memory_budget_widths(DDSolver& solver, Options& options)
+{
+	if (options.memory_budget <= 0) {
+		return;
+	}
+	cout << "Layer widths:";
+	for (int layer_width : solver.layer_widths) {
+		cout << " " << layer_width;
+	}
+	cout << endl;
+	cout << "Estimated memory: " << solver.memory_estimate / (1024 * 1024) << " MB (budget: " << options.memory_budget
+	     << " MB)" << endl;
+}
+
+
+/**
+ * Build a restricted DD of width options.restricted_width, print its best solution and return its value (-infinity if
+ * the restricted DD has no solution)
+ */
+template<class ProblemT>
+static double find_restricted_primal_bound(ProblemT* problem, Options& options)
+{
+	Stats stats;
+	stats.register_name("time-restricted-bdd");
+	stats.start_timer(0);
+
+	TypedDDSolver<ProblemT> solver(problem, &options);
+	BDD* bdd = solver.construct_restricted_decision_diagram(options.restricted_width);
+
+	double primal_bound = -numeric_limits<double>::infinity();
+	vector<int> primal_sol;
+	if (bdd != NULL) {
+		vector<double> weights(problem->inst->weights, problem->inst->weights + problem->inst->nvars);
+		primal_bound = bdd->get_optimal_sol(weights, primal_sol, true);
+	}
+	delete bdd;
+
+	stats.end_timer(0);
 
+	cout << endl;
+	cout << endl << "Lower bound: " << primal_bound << " - restricted width: " << options.restricted_width << endl;
+	if (!primal_sol.empty()) {
+		cout << "Restricted solution:";
+		for (int var = 0; var < (int) primal_sol.size(); ++var) {
+			if (primal_sol[var] == 1) {
+				cout << " " << var;
+			}
+		}
+		cout << endl;
+	}
+	cout << "Time to build restricted BDD: " << stats.get_time(0) << endl;
+
+	return primal_bound;
+}
+
+
+/**
+ * Solve an independent set problem with DD-based branch-and-bound. The given problem is used by the first thread, and
+ * each other thread gets a copy with its own ordering and merger.
+ */
+static void solve_indepset_bnb(IndepSetProblem* problem, int order_n, int merge_n, Options& options)
+{
+	IndepSetInstance* inst = problem->instance;
+
+	vector<Problem*> problems;
+	problems.push_back(problem);
+	for (int t = 1; t < options.bnb_threads; ++t) {
+		IndepSetProblem* thread_problem = new IndepSetProblem(inst, &options);
+		thread_problem->ordering = get_ordering_by_id_indepset(order_n, inst, options);
+		thread_problem->merger = get_merger_by_id_indepset(merge_n, options.width);
+		problems.push_back(thread_problem);
+	}
+	for (Problem* prob : problems) {
+		if (prob->completion == NULL) {
+			prob->completion = new StateWeightCompletionBound();
+		}
+	}
+
+	Stats stats;
+	stats.register_name("time-bnb");
+	stats.start_timer(0);
+
+	int restricted_width = (options.restricted_width > 0) ? options.restricted_width : options.width;
+	TypedDDBranchAndBound<IndepSetProblem> bnb(problems, restricted_width, &options);
+	bnb.solve(options.bnb_time_limit);
+
+	stats.end_timer(0);
+
+	cout << endl;
+	cout << endl << "Lower bound: " << bnb.incumbent << " - upper bound: " << bnb.dual_bound;
+	cout << (bnb.time_limit_reached ? " - time limit reached" : " - optimal") << endl;
+	cout << "Solution:";
+	for (int var : bnb.incumbent_sol) {
+		cout << " " << var;
+	}
+	cout << endl;
+	cout << "Subproblems: " << bnb.nsubproblems << endl;
+	cout << "Time for branch-and-bound: " << stats.get_time(0) << endl;
+
+	for (int t = 1; t < (int) problems.size(); ++t) {
+		delete problems[t];
+	}
+}
 
 
 /** Main processing for an independent set problem */
@@ -75,6 +192,21 @@ void main_indepset(int order_n, int merge_n, string instance_path, string instan
 	problem->ordering = ordering;
 	problem->merger = merger;
 
+	// With a static ordering, number states by layer so that they shrink as layers advance. Not with several
+	// branch-and-bound threads, since each thread has its own ordering, nor with an ordered node pool, whose order of
+	// states would no longer be the original one.
+	if (ordering->is_static() && (!options.bnb || options.bnb_threads <= 1) && !options.ordered_node_pool) {
+		inst->renumber_for_ordering(ordering);
+	}
+
+	// Solve with DD-based branch-and-bound if required
+	if (options.bnb) {
+		solve_indepset_bnb(problem, order_n, merge_n, options);
+		delete problem;
+		delete inst;
+		return;
+	}
+
 	// Construct DD if required
 	BDD* bdd = NULL;
 	if (!skip_dd) {
@@ -82,15 +214,33 @@ void main_indepset(int order_n, int merge_n, string instance_path, string instan
 		stats.register_name("time-bdd");
 		stats.start_timer(0);
 	
-		DDSolver solver(problem, &options);
+		double primal_bound = -numeric_limits<double>::infinity();
+		if (options.restricted_width > 0) {
+			primal_bound = find_restricted_primal_bound(problem, options);
+		}
+
+		TypedDDSolver<IndepSetProblem> solver(problem, &options);
+
+		// A DD pruned by a primal bound only keeps solutions better than it, so its cuts are not valid for the IP
+		if (options.restricted_width > 0 && dd_only) {
+			if (problem->completion == NULL) {
+				problem->completion = new StateWeightCompletionBound();
+			}
+			solver.set_primal_bound(primal_bound);
+		}
 
 		bdd = solver.construct_decision_diagram();
-		assert(bdd->integrity_check()); // Sanity checks on debug mode
+		assert(bdd == NULL || bdd->integrity_check()); // Sanity checks on debug mode
 
 		stats.end_timer(0);
 
 		cout << endl;
-		cout << endl << "Upper bound: " << bdd->bound << " - width: " << solver.final_width << endl;
+		if (bdd == NULL) {
+			cout << endl << "Upper bound: " << primal_bound << " - restricted solution is optimal" << endl;
+		} else {
+			cout << endl << "Upper bound: " << bdd->bound << " - width: " << solver.final_width << endl;
+		}
+		print_memory_budget_widths(solver, options);
 		cout << "Time to build BDD: " << stats.get_time(0) << endl;
 	}
 
@@ -116,16 +266,147 @@ void main_indepset(int order_n, int merge_n, string instance_path, string instan
 }
 
 
+/** Print the counts of rows scanned and variables fixed by each domain propagator of the problem */
+static void print_propagation_counts(BinaryProblem& problem)
+{
+	if (problem.propagator == NULL) {
+		return;
+	}
+	const vector<BPProp*>& propagators = problem.propagator->get_propagators();
+	for (int i = 0; i < (int) propagators.size(); ++i) {
+		cout << "Propagator " << i << ": " << propagators[i]->get_nrows_scanned() << " rows scanned, "
+		     << propagators[i]->get_nfixings() << " fixings" << endl;
+	}
+}
+
+
+/** Main processing for a binary program whose rows are all set covering rows; takes ownership of the instance */
+static void main_setcover(BPInstance* inst, int order_n, int merge_n, string instance_path, bool skip_dd, bool dd_only,
+	Options& options)
+{
+	SetCoverProblem problem(inst, &options);
+
+	cout << endl << "Set covering rows detected: using set covering states" << endl;
+
+	// Assign ordering and merger
+	if (order_n < 0) {
+		order_n = DEFAULT_SETCOVER_ORDERING;
+	}
+	if (merge_n < 0) {
+		merge_n = DEFAULT_SETCOVER_MERGING;
+	}
+	Ordering* ordering = get_ordering_by_id_setcover(order_n, inst, options);
+	if (ordering == NULL) {
+		cout << "Error: invalid variable ordering" << endl;
+		exit(1);
+	}
+	Merger* merger = get_merger_by_id_setcover(merge_n, options.width);
+	if (merger == NULL) {
+		cout << "Error: invalid merging scheme" << endl;
+		exit(1);
+	}
+	problem.ordering = ordering;
+	problem.merger = merger;
+
+	if (options.bnb) {
+		cout << "Error: DD-based branch-and-bound is not supported for binary problems" << endl;
+		exit(1);
+	}
+
+	// With a static ordering, number rows by layer so that covered rows leave the states as layers advance. Not with an
+	// ordered node pool, whose order of states would no longer be the original one.
+	if (ordering->is_static() && !options.ordered_node_pool) {
+		problem.renumber_for_ordering(ordering);
+	}
+
+	BDD* bdd = NULL;
+	if (!skip_dd) {
+		Stats stats;
+		stats.register_name("time-bdd");
+		stats.start_timer(0);
+
+		double primal_bound = -numeric_limits<double>::infinity();
+		if (options.restricted_width > 0) {
+			primal_bound = find_restricted_primal_bound(&problem, options);
+		}
+
+		TypedDDSolver<SetCoverProblem> solver(&problem, &options);
+
+		// A DD pruned by a primal bound only keeps solutions better than it, so its cuts are not valid for the IP
+		if (options.restricted_width > 0 && dd_only) {
+			if (problem.completion == NULL) {
+				problem.completion = new SetCoverRowCompletionBound(&problem);
+			}
+			solver.set_primal_bound(primal_bound);
+		}
+
+		bdd = solver.construct_decision_diagram();
+		assert(bdd == NULL || bdd->integrity_check()); // Sanity checks on debug mode
+
+		stats.end_timer(0);
+
+		cout << endl;
+		if (bdd == NULL && primal_bound > -numeric_limits<double>::infinity()) {
+			cout << "Bound: " << primal_bound << " (restricted solution is optimal)" << endl;
+		} else if (bdd == NULL) {
+			cout << "Bound: Infeasible" << endl;
+		} else {
+			cout << "Bound: " << bdd->bound << endl;
+		}
+		cout << "Width: " << solver.final_width << endl;
+		print_memory_budget_widths(solver, options);
+		cout << "Time to construct BDD: " << stats.get_time(0) << endl;
+	}
+
+	// Set default interior point
+	if (!dd_only && options.cut_interior_point < 0) {
+#ifdef USE_GMP
+		options.cut_interior_point = INTPT_DDCENTER;
+#else
+		if (options.limit_ncuts == -1 || options.limit_ncuts > 0) {
+			cout << endl;
+			cout << "Error: Compilation was done without GMP. The default interior point for cuts from binary programs is the center" << endl;
+			cout << "       of a decision diagram, which requires GMP. A different interior point must be set with --cut-intpt." << endl;
+		}
+		delete inst;
+		delete bdd;
+		exit(1);
+#endif
+	}
+
+	if (!dd_only) {
 #ifdef SOLVER_CPLEX
+		BPModelCplex model_builder(instance_path);
+		solve_ip(inst, bdd, &model_builder, &options);
+#else
+		cout << endl;
+		cout << "Error: Compilation was done without CPLEX; cannot run IP model" << endl;
+#endif
+	}
+
+	delete inst;
+	delete bdd;
+}
+
 
 void main_bp(int order_n, int merge_n, string instance_path, string instance_filename, bool skip_dd, bool dd_only,
 	Options& options)
 {
 	/* binary program */
-	BPInstance* inst = read_bp_instance_cplex_mps(instance_path);
+	BPInstance* inst = read_bp_instance_mps(instance_path);
 	for (BPRow* row : inst->rows) {
 		cout << *row << endl;
 	}
+	const BPMatrix& matrix = inst->matrix;
+	cout << "Rows: " << matrix.get_nrows_class(ROW_UNIT) << " unit, " << matrix.get_nrows_class(ROW_INTEGRAL)
+	     << " integral, " << matrix.get_nrows_class(ROW_GENERAL) << " general; right-hand sides stored as "
+	     << ((matrix.rhs_type == RHS_INT16) ? "int16" : ((matrix.rhs_type == RHS_INT32) ? "int32" : "double")) << endl;
+
+	// Set covering instances have a dedicated problem with smaller states
+	if (options.bp_setcover_state && is_set_cover_instance(inst)) {
+		main_setcover(inst, order_n, merge_n, instance_path, skip_dd, dd_only, options);
+		return;
+	}
 
 	// Create binary problem
 	vector<BPProp*> props;
@@ -152,31 +433,59 @@ void main_bp(int order_n, int merge_n, string instance_path, string instance_fil
 	problem.ordering = ordering;
 	problem.merger = merger;
 
+	if (options.bnb) {
+		cout << "Error: DD-based branch-and-bound is not supported for binary problems" << endl;
+		exit(1);
+	}
+
+	// With a static ordering, number rows by layer so that retired rows leave the states as layers advance. Not with an
+	// ordered node pool, whose order of states would no longer be the original one.
+	if (ordering->is_static() && !options.ordered_node_pool) {
+		inst->renumber_for_ordering(ordering);
+	}
+
 	BDD* bdd = NULL;
 	if (!skip_dd) {
 		Stats stats;
 		stats.register_name("time-bdd");
 		stats.start_timer(0);
 
-		DDSolver solver(&problem, &options);
+		double primal_bound = -numeric_limits<double>::infinity();
+		if (options.restricted_width > 0) {
+			primal_bound = find_restricted_primal_bound(&problem, options);
+		}
+
+		TypedDDSolver<BinaryProblem> solver(&problem, &options);
+
+		// A DD pruned by a primal bound only keeps solutions better than it, so its cuts are not valid for the IP
+		if (options.restricted_width > 0 && dd_only) {
+			if (problem.completion == NULL) {
+				problem.completion = new BPDomainCompletionBound();
+			}
+			solver.set_primal_bound(primal_bound);
+		}
 
 		bdd = solver.construct_decision_diagram();
-		assert(bdd->integrity_check()); // Sanity checks on debug mode
+		assert(bdd == NULL || bdd->integrity_check()); // Sanity checks on debug mode
 
 		stats.end_timer(0);
 
 		cout << endl;
-		if (bdd == NULL) {
+		if (bdd == NULL && primal_bound > -numeric_limits<double>::infinity()) {
+			cout << "Bound: " << primal_bound << " (restricted solution is optimal)" << endl;
+		} else if (bdd == NULL) {
 			cout << "Bound: Infeasible" << endl;
 		} else {
 			cout << "Bound: " << bdd->bound << endl;
 		}
 		cout << "Width: " << solver.final_width << endl;
+		print_memory_budget_widths(solver, options);
+		print_propagation_counts(problem);
 		cout << "Time to construct BDD: " << stats.get_time(0) << endl;
 	}
 
 	// Set default interior point
-	if (options.cut_interior_point < 0) {
+	if (!dd_only && options.cut_interior_point < 0) {
 #ifdef USE_GMP
 		options.cut_interior_point = INTPT_DDCENTER;
 #else
@@ -192,20 +501,15 @@ void main_bp(int order_n, int merge_n, string instance_path, string instance_fil
 	}
 
 	if (!dd_only) {
+#ifdef SOLVER_CPLEX
 		BPModelCplex model_builder(instance_path);
 		solve_ip(inst, bdd, &model_builder, &options);
+#else
+		cout << endl;
+		cout << "Error: Compilation was done without CPLEX; cannot run IP model" << endl;
+#endif
 	}
 
 	delete inst;
 	delete bdd;
 }
-
-#else
-
-void main_bp(int order_n, int merge_n, string instance_path, string instance_filename, bool skip_dd, bool dd_only,
-	Options& options)
-{
-		cout << "Error: Compilation was done without CPLEX; cannot read MPS file" << endl;
-}
-
-#endif
@@ -0,0 +1,31 @@
+/**
+ * Completion bounds for binary problems
+ */
+
+#ifndef BP_COMPLETION_HPP_
+#define BP_COMPLETION_HPP_
+
+#include "../../core/completion.hpp"
+#include "bp_state.hpp"
+
+
+/** Sum of the weights of the unprocessed variables that can still be assigned to 1, counting only positive ones if free */
+class BPDomainCompletionBound : public CompletionBound
+{
+	double dual_bound(Instance* inst, Node* node, Node* parent)
+	{
+		BPState* state = static_cast<BPState*>(node->state);
+		double bound = 0;
+		for (BPDomainsUnprocIterator it = state->domains.begin_unproc(); it != state->domains.end_unproc(); ++it) {
+			BPDomain domain = state->domains[*it];
+			if (domain == DOM_ONE) {
+				bound += inst->weights[*it];
+			} else if (domain == DOM_ZERO_ONE) {
+				bound += MAX(0, inst->weights[*it]);
+			}
+		}
+		return bound;
+	}
+};
+
+#endif /* BP_COMPLETION_HPP_ */
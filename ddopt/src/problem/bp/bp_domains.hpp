@@ -6,9 +6,12 @@
 #define BPDOMAINS_HPP_
 
 #include <vector>
+#include <iterator>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include "../../util/hash.hpp"
 
 using namespace std;
 
@@ -17,331 +20,188 @@ enum BPDomain {
 	DOM_ZERO = 0,
 	DOM_ONE = 1,
 
-	DOM_PROCESSED, // Already processed during DD construction; that is, corresponds to a previous layer
-
-	DOM_UNDEFINED // For sentinel nodes
+	DOM_PROCESSED // Already processed during DD construction; that is, corresponds to a previous layer
 };
 
 
-/* The structures here allow faster iteration through set, unset, or unprocessed domains.
- * Note that while set and unset iteration is unordered (since variables may be set or unset through branching and merge),
- * unprocessed iteration is ordered since a processed variable never becomes unprocessed again, and this is necessary
- * since we use it for equivalence checks. */
-
-#define BP_DOMAIN_NODE_NULL -1 // must be < 0
-
-/** Node containing domain and structure for traversals */
-struct BPDomainNode {
-	BPDomain domain;
-	int var;
-
-	/* "Pointers" to previous/next nodes that are set (DOM_ZERO or DOM_ONE), unset (DOM_ZERO_ONE),
-	 * or unprocessed (all except DOM_PROCESSED).
-	 * These are implemented as int since copying states is very frequent and this avoid rearranging pointers to
-	 * new nodes in each copy. Profiling suggests that copies could be expensive given its frequency.
-	 * Here, ints correspond to indices, and BP_DOMAIN_NODE_NULL corresponds to NULL.
-	 */
-	int prev_set;
-	int prev_unset;
-	int prev_unproc;
-	int next_set;
-	int next_unset;
-	int next_unproc;
-
-	BPDomainNode(BPDomain _domain, int _var) : domain(_domain), var(_var),
-		prev_set(BP_DOMAIN_NODE_NULL), prev_unset(BP_DOMAIN_NODE_NULL), prev_unproc(BP_DOMAIN_NODE_NULL),
-		next_set(BP_DOMAIN_NODE_NULL), next_unset(BP_DOMAIN_NODE_NULL), next_unproc(BP_DOMAIN_NODE_NULL) {}
-
-	BPDomainNode() : BPDomainNode(DOM_UNDEFINED, -1) {}
+/* Domains are packed into two bits per variable, stored as two bit planes: whether 0 is in the domain and whether 1 is
+ * in the domain. A processed variable has neither, so that the masks of set ({0} or {1}), unset ({0,1}) and unprocessed
+ * variables are each a single operation on a pair of words, and iteration finds the next bit set in these masks.
+ * All iterations are ordered by variable; unprocessed iteration must be, since we use it for comparisons of states. */
 
-	BPDomainNode& operator=(const BPDomainNode& rhs)
-	{
-		domain = rhs.domain;
-		var = rhs.var;
-		prev_set = rhs.prev_set;
-		prev_unset = rhs.prev_unset;
-		prev_unproc = rhs.prev_unproc;
-		next_set = rhs.next_set;
-		next_unset = rhs.next_unset;
-		next_unproc = rhs.next_unproc;
-		return *this;
-	}
+typedef uint64_t BPDomainsWord;
 
-	bool operator==(const BPDomainNode& rhs) const
-	{
-		return (var == rhs.var);
-	}
+#define BP_DOMAINS_WORD_BITS 64
 
-	bool operator!=(const BPDomainNode& rhs) const
-	{
-		return (var != rhs.var);
-	}
+/** Class of domains to iterate over */
+enum BPDomainClass {
+	DOMCLASS_SET,        // DOM_ZERO or DOM_ONE
+	DOMCLASS_UNSET,      // DOM_ZERO_ONE
+	DOMCLASS_UNPROC      // all except DOM_PROCESSED
 };
 
-
-/** Iterator for set variables */
-template <typename Node> // for purposes of defining both non-const and const iterators
-class BPDomainsSetIteratorBase : public iterator<forward_iterator_tag, int>
+/** Mask of the variables of a word whose domains are in the given class */
+template <BPDomainClass Class>
+inline BPDomainsWord bp_domains_class_mask(BPDomainsWord zero_bits, BPDomainsWord one_bits)
 {
-	friend class BPDomains;
-
-	int idx;
-	const vector<BPDomainNode>* domains;
-
-	BPDomainsSetIteratorBase(int _idx, const vector<BPDomainNode>* _domains) : idx(_idx), domains(_domains) {}
-
-public:
-
-	Node& operator*() const
-	{
-		return (*domains)[idx];
-	}
-	const Node* operator->() const
-	{
-		return &(*domains)[idx];
+	switch (Class) {
+	case DOMCLASS_SET:
+		return zero_bits ^ one_bits;
+	case DOMCLASS_UNSET:
+		return zero_bits & one_bits;
+	default:
+		return zero_bits | one_bits;
 	}
-
-	const BPDomainsSetIteratorBase& operator++()
-	{
-		idx = (*domains)[idx].next_set;
-		return *this;
-	}
-	const BPDomainsSetIteratorBase operator++(int)
-	{
-		BPDomainsSetIteratorBase temp(*this);
-		idx = (*domains)[idx].next_set;
-		return temp;
-	}
-
-	bool operator==(const BPDomainsSetIteratorBase& other) const
-	{
-		return idx == other.idx;
-	}
-	bool operator!=(const BPDomainsSetIteratorBase& other) const
-	{
-		return idx != other.idx;
-	}
-};
-
-typedef BPDomainsSetIteratorBase<BPDomainNode> BPDomainsSetIterator;
-typedef BPDomainsSetIteratorBase<const BPDomainNode> BPDomainsSetConstIterator;
+}
 
 
-/** Iterator for unset variables */
-template <typename Node> // for purposes of defining both non-const and const iterators
-class BPDomainsUnsetIteratorBase : public iterator<forward_iterator_tag, int>
+/** Iterator over the variables whose domains are in a given class; dereferences to the variable */
+template <BPDomainClass Class>
+class BPDomainsIteratorBase : public iterator<forward_iterator_tag, int>
 {
 	friend class BPDomains;
 
-	int idx;
-	const vector<BPDomainNode>* domains;
-
-	BPDomainsUnsetIteratorBase(int _idx, const vector<BPDomainNode>* _domains) : idx(_idx), domains(_domains) {}
-
-public:
-
-	Node& operator*() const
-	{
-		return (*domains)[idx];
-	}
-	const Node* operator->() const
-	{
-		return &(*domains)[idx];
-	}
+	const BPDomainsWord* words;     /**< pairs of words (zero bits, one bits) */
+	int nwords;                     /**< number of pairs */
+	int word;                       /**< current pair, or nwords at the end */
+	BPDomainsWord bits;             /**< variables of the current pair not visited yet */
 
-	const BPDomainsUnsetIteratorBase& operator++()
+	BPDomainsIteratorBase(const BPDomainsWord* _words, int _nwords, int _word) : words(_words), nwords(_nwords),
+		word(_word), bits(0)
 	{
-		idx = (*domains)[idx].next_unset;
-		return *this;
-	}
-	const BPDomainsUnsetIteratorBase operator++(int)
-	{
-		BPDomainsUnsetIteratorBase temp(*this);
-		idx = (*domains)[idx].next_unset;
-		return temp;
+		if (word < nwords) {
+			bits = bp_domains_class_mask<Class>(words[2 * word], words[2 * word + 1]);
+			if (bits == 0) {
+				advance();
+			}
+		}
 	}
 
-	bool operator==(const BPDomainsUnsetIteratorBase& other) const
+	/** Move to the next pair of words with a variable in the class */
+	void advance()
 	{
-		return idx == other.idx;
-	}
-	bool operator!=(const BPDomainsUnsetIteratorBase& other) const
-	{
-		return idx != other.idx;
+		while (++word < nwords) {
+			bits = bp_domains_class_mask<Class>(words[2 * word], words[2 * word + 1]);
+			if (bits != 0) {
+				return;
+			}
+		}
+		bits = 0;
 	}
-};
-
-typedef BPDomainsUnsetIteratorBase<BPDomainNode> BPDomainsUnsetIterator;
-typedef BPDomainsUnsetIteratorBase<const BPDomainNode> BPDomainsUnsetConstIterator;
-
-
-/** Iterator for unprocessed variables */
-template <typename Node> // for purposes of defining both non-const and const iterators
-class BPDomainsUnprocIteratorBase : public iterator<forward_iterator_tag, int>
-{
-	friend class BPDomains;
-
-	int idx;
-	const vector<BPDomainNode>* domains;
-
-	BPDomainsUnprocIteratorBase(int _idx, const vector<BPDomainNode>* _domains) : idx(_idx), domains(_domains) {}
 
 public:
 
-	Node& operator*() const
-	{
-		return (*domains)[idx];
-	}
-	const Node* operator->() const
+	int operator*() const
 	{
-		return &(*domains)[idx];
+		return word * BP_DOMAINS_WORD_BITS + __builtin_ctzll(bits);
 	}
 
-	const BPDomainsUnprocIteratorBase& operator++()
+	const BPDomainsIteratorBase& operator++()
 	{
-		idx = (*domains)[idx].next_unproc;
+		bits &= bits - 1;
+		if (bits == 0) {
+			advance();
+		}
 		return *this;
 	}
-	const BPDomainsUnprocIteratorBase operator++(int)
+	const BPDomainsIteratorBase operator++(int)
 	{
-		BPDomainsUnprocIteratorBase temp(*this);
-		idx = (*domains)[idx].next_unproc;
+		BPDomainsIteratorBase temp(*this);
+		++(*this);
 		return temp;
 	}
 
-	bool operator==(const BPDomainsUnprocIteratorBase& other) const
+	bool operator==(const BPDomainsIteratorBase& other) const
 	{
-		return idx == other.idx;
+		return word == other.word && bits == other.bits;
 	}
-	bool operator!=(const BPDomainsUnprocIteratorBase& other) const
+	bool operator!=(const BPDomainsIteratorBase& other) const
 	{
-		return idx != other.idx;
+		return !(*this == other);
 	}
 };
 
-typedef BPDomainsUnprocIteratorBase<BPDomainNode> BPDomainsUnprocIterator;
-typedef BPDomainsUnprocIteratorBase<const BPDomainNode> BPDomainsUnprocConstIterator;
+typedef BPDomainsIteratorBase<DOMCLASS_SET> BPDomainsSetIterator;
+typedef BPDomainsIteratorBase<DOMCLASS_UNSET> BPDomainsUnsetIterator;
+typedef BPDomainsIteratorBase<DOMCLASS_UNPROC> BPDomainsUnprocIterator;
 
 
 /**
- * Essentially a vector of BPDomains, but allows (unordered) iterations over set or unset variables.
+ * Essentially a vector of BPDomains, but allows iterations over set, unset, or unprocessed variables.
  */
 class BPDomains
 {
 public:
-	// domains has nvars + 2 elements: it stores start (head) and end (tail) of list for convenience at nvars and nvars+1
-	vector<BPDomainNode> domains;
+	vector<BPDomainsWord> words;  /**< pairs of words per BP_DOMAINS_WORD_BITS variables: 0 in domain, 1 in domain */
 	int nvars;
+	int nwords;                   /**< number of pairs of words */
 	int nvars_set_zero;
 	int nvars_set_one;
+	size_t hash_val;              /**< XOR of the hash keys of (variable, domain) pairs; updated at each domain change */
 
 	BPDomains() {}
-	BPDomains(const BPDomains& rhs);
 	void init(int _nvars);
 
 	~BPDomains() {}
 
 	BPDomain operator[](int i) const
 	{
-		return domains[i].domain;
+		static const BPDomain code_domains[] = {DOM_PROCESSED, DOM_ZERO, DOM_ONE, DOM_ZERO_ONE};
+		int w = 2 * (i / BP_DOMAINS_WORD_BITS);
+		int b = i % BP_DOMAINS_WORD_BITS;
+		return code_domains[((words[w] >> b) & 1) | (((words[w + 1] >> b) & 1) << 1)];
 	}
 
-	int size()
+	/** Return true if all domains are the same as in rhs */
+	bool operator==(const BPDomains& rhs) const
 	{
-		return nvars;
+		assert(nvars == rhs.nvars);
+		return memcmp(words.data(), rhs.words.data(), words.size() * sizeof(BPDomainsWord)) == 0;
 	}
 
-	int start_index() const
+	int size() const
 	{
 		return nvars;
 	}
-	int end_index() const
+
+	/** Bytes allocated outside of the object itself */
+	size_t get_allocated_bytes() const
 	{
-		return nvars + 1;
+		return words.capacity() * sizeof(BPDomainsWord);
 	}
 
-	BPDomains& operator=(const BPDomains& rhs);
-
-	/** Set domain of variable i to dom, adjusting pointers in the process */
+	/** Set domain of variable i to dom */
 	void set_domain(int i, BPDomain dom);
 
-	BPDomainsSetIterator begin_set()
-	{
-		return BPDomainsSetIterator(domains[start_index()].next_set, &domains);
-	}
-	BPDomainsSetIterator end_set()
-	{
-		return BPDomainsSetIterator(end_index(), &domains);
-	}
-	BPDomainsUnsetIterator begin_unset()
-	{
-		return BPDomainsUnsetIterator(domains[start_index()].next_unset, &domains);
-	}
-	BPDomainsUnsetIterator end_unset()
-	{
-		return BPDomainsUnsetIterator(end_index(), &domains);
-	}
-	BPDomainsUnprocIterator begin_unproc()
-	{
-		return BPDomainsUnprocIterator(domains[start_index()].next_unproc, &domains);
-	}
-	BPDomainsUnprocIterator end_unproc()
+	/** Hash key of variable i having domain dom */
+	static size_t domain_hash_key(int i, BPDomain dom)
 	{
-		return BPDomainsUnprocIterator(end_index(), &domains);
+		return hash_key(i, dom - DOM_ZERO_ONE);
 	}
 
-	const BPDomainsSetConstIterator begin_set() const
-	{
-		return BPDomainsSetConstIterator(domains[start_index()].next_set, &domains);
-	}
-	const BPDomainsSetConstIterator end_set() const
+	BPDomainsSetIterator begin_set() const
 	{
-		return BPDomainsSetConstIterator(end_index(), &domains);
+		return BPDomainsSetIterator(words.data(), nwords, 0);
 	}
-	const BPDomainsUnsetConstIterator begin_unset() const
+	BPDomainsSetIterator end_set() const
 	{
-		return BPDomainsUnsetConstIterator(domains[start_index()].next_unset, &domains);
+		return BPDomainsSetIterator(words.data(), nwords, nwords);
 	}
-	const BPDomainsUnsetConstIterator end_unset() const
+	BPDomainsUnsetIterator begin_unset() const
 	{
-		return BPDomainsUnsetConstIterator(end_index(), &domains);
+		return BPDomainsUnsetIterator(words.data(), nwords, 0);
 	}
-	const BPDomainsUnprocConstIterator begin_unproc() const
+	BPDomainsUnsetIterator end_unset() const
 	{
-		return BPDomainsUnprocConstIterator(domains[start_index()].next_unproc, &domains);
+		return BPDomainsUnsetIterator(words.data(), nwords, nwords);
 	}
-	const BPDomainsUnprocConstIterator end_unproc() const
+	BPDomainsUnprocIterator begin_unproc() const
 	{
-		return BPDomainsUnprocConstIterator(end_index(), &domains);
+		return BPDomainsUnprocIterator(words.data(), nwords, 0);
 	}
-
-private:
-
-	void add_set(int i);
-	void remove_set(int i);
-	void add_unset(int i);
-	void remove_unset(int i);
-	// add_unprocessed, if implemented, should be used carefully because it may break the order of unprocessed variables
-	void remove_unprocessed(int i);
-
-	bool consistent(int i)
+	BPDomainsUnprocIterator end_unproc() const
 	{
-		return (((domains[i].prev_set == BP_DOMAIN_NODE_NULL && domains[i].next_set == BP_DOMAIN_NODE_NULL)
-		         || (domains[domains[i].next_set].prev_set == i && domains[domains[i].prev_set].next_set == i))
-		        && ((domains[i].prev_unset == BP_DOMAIN_NODE_NULL && domains[i].next_unset == BP_DOMAIN_NODE_NULL)
-		            || (domains[domains[i].next_unset].prev_unset == i && domains[domains[i].prev_unset].next_unset == i))
-		        && ((domains[i].prev_unproc == BP_DOMAIN_NODE_NULL && domains[i].next_unproc == BP_DOMAIN_NODE_NULL)
-		            || (domains[domains[i].next_unproc].prev_unproc == i && domains[domains[i].prev_unproc].next_unproc == i)));
-	}
-
-	bool consistent_all()
-	{
-		for (int i = 0; i < nvars; ++i) {
-			if (!consistent(i)) {
-				return false;
-			}
-		}
-		return true;
+		return BPDomainsUnprocIterator(words.data(), nwords, nwords);
 	}
 };
 
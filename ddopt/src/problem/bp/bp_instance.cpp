@@ -0,0 +1,70 @@
+/**
+ * Binary problem instance
+ */
+
+#include <algorithm>
+#include <cassert>
+#include "bp_instance.hpp"
+#include "../../util/util.hpp"
+
+
+void BPInstance::renumber_for_ordering(Ordering* ordering)
+{
+	assert(ordering->is_static());
+
+	vector<int> var_layer(nvars, -1);
+	for (int layer = 0; layer < nvars; layer++) {
+		int var = ordering->select_next_var(layer);
+		if (var < 0 || var >= nvars || var_layer[var] >= 0) {
+			cout << "Error: ordering is not a permutation of the variables" << endl;
+			exit(1);
+		}
+		var_layer[var] = layer;
+	}
+
+	// Order rows by the layer of their last variable; rows without variables come first
+	vector<int> row_last_layer(nrows, -1);
+	for (int i = 0; i < nrows; ++i) {
+		for (int k = matrix.row_start[i]; k < matrix.row_start[i + 1]; ++k) {
+			row_last_layer[i] = MAX(row_last_layer[i], var_layer[matrix.row_ind[k]]);
+		}
+	}
+	vector<int> row_in_position(nrows);
+	for (int i = 0; i < nrows; ++i) {
+		row_in_position[i] = i;
+	}
+	stable_sort(row_in_position.begin(), row_in_position.end(), [&](int a, int b) {
+		return row_last_layer[a] < row_last_layer[b];
+	});
+
+	vector<int> row_position(nrows);
+	vector<BPRow*> old_rows(rows);
+	for (int p = 0; p < nrows; ++p) {
+		rows[p] = old_rows[row_in_position[p]];
+		row_position[row_in_position[p]] = p;
+	}
+	for (BPVar* var : vars) {
+		for (int& row : var->rows) {
+			row = row_position[row];
+		}
+	}
+	matrix.init(vars, rows);
+
+	// After the layer of a variable, only rows whose last variable comes later are open
+	int p = 0;
+	while (p < nrows && row_last_layer[row_in_position[p]] < 0) {
+		p++;
+	}
+	first_open_row = p;
+	vector<int> layer_first_open(nvars);
+	for (int layer = 0; layer < nvars; layer++) {
+		while (p < nrows && row_last_layer[row_in_position[p]] <= layer) {
+			p++;
+		}
+		layer_first_open[layer] = p;
+	}
+	for (int var = 0; var < nvars; ++var) {
+		var_first_open_row[var] = layer_first_open[var_layer[var]];
+	}
+	layer_rows = true;
+}
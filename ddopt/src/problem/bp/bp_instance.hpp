@@ -6,8 +6,10 @@
 #define BP_INSTANCE_HPP_
 
 #include "../instance.hpp"
+#include "../../core/order.hpp"
 #include "bpvar.hpp"
 #include "bprow.hpp"
+#include "bp_matrix.hpp"
 
 using namespace std;
 
@@ -20,10 +22,16 @@ class BPInstance : public Instance
 public:
 	vector<BPVar*>                  vars;                        /**< variables */
 	vector<BPRow*>                  rows;                        /**< constraints */
+	BPMatrix                        matrix;                      /**< constraint matrix stored by row and by column */
 
 	// int nvars in base Instance class
 	int                             nrows;
 
+	// Rows retired by layer; see renumber_for_ordering
+	bool                            layer_rows;                  /**< true if rows are numbered for a static ordering */
+	int                             first_open_row;              /**< rows below it have no variables */
+	vector<int32_t>                 var_first_open_row;          /**< rows below it have no variable after the layer of each variable */
+
 	BPInstance(vector<BPVar*> _vars, vector<BPRow*> _rows) : vars(_vars), rows(_rows)
 	{
 		nvars = _vars.size();
@@ -33,12 +41,24 @@ public:
 		for (int i = 0; i < nvars; i++) {
 			weights[i] = _vars[i]->obj;
 		}
+
+		matrix.init(vars, rows);
+
+		layer_rows = false;
+		first_open_row = 0;
+		var_first_open_row.assign(nvars, 0);
 	}
 
 	~BPInstance()
 	{
 		delete[] weights;
 	}
+
+	/**
+	 * Number rows by the layer of their last variable in a static ordering, so that the rows retired after each layer,
+	 * which have no unprocessed variables left, are a prefix that states do not need to keep.
+	 */
+	void renumber_for_ordering(Ordering* ordering);
 };
 
 
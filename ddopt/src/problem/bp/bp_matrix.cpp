@@ -0,0 +1,168 @@
+/**
+ * Constraint matrix for binary problems
+ */
+
+#include <cassert>
+#include <cmath>
+#include "bp_matrix.hpp"
+
+#define BP_MAX_INTEGRAL_COEFF 1e9   /* larger integral values are treated as general so that activities stay exact */
+#define BP_MAX_ROW_SCALE      1e6   /* largest factor by which a row is scaled to make its coefficients integral */
+#define BP_MAX_SCALE_STEP     1000  /* largest factor by which the scale grows for a single coefficient */
+#define BP_INTEGRAL_TOL       1e-9  /* relative tolerance within which a scaled value is taken as integral */
+
+
+/** Return true if a value is an integer small enough for sums of coefficients to be exact in a double */
+static bool is_small_integer(double val)
+{
+	return val == floor(val) && fabs(val) <= BP_MAX_INTEGRAL_COEFF;
+}
+
+
+/** Return true if a value is within tolerance of an integer, as decimal data such as 0.1 read from a file is */
+static bool is_near_integer(double val)
+{
+	return fabs(val - round(val)) <= BP_INTEGRAL_TOL * MAX(1, fabs(val));
+}
+
+
+/**
+ * Smallest positive factor by which all coefficients of a row become integral, found one coefficient at a time, or 0 if
+ * it is larger than BP_MAX_ROW_SCALE. Rows with fractional coefficients such as thirds or decimals are scaled by it.
+ */
+static double find_row_scale(const BPRow* row)
+{
+	double scale = 1;
+	for (int j = 0; j < row->nnonz; ++j) {
+		int step = 1;
+		while (!is_near_integer(row->coeffs[j] * scale * step)) {
+			if (++step > BP_MAX_SCALE_STEP || scale * step > BP_MAX_ROW_SCALE) {
+				return 0;
+			}
+		}
+		scale *= step;
+	}
+	return scale;
+}
+
+
+/**
+ * Scale a row so that its coefficients and rhs are integral, writing them to coeffs and rhs; a row whose coefficients are
+ * all negative is negated and its sense flipped, so that packing and covering rows are recognized in either form. The rhs
+ * is rounded towards the feasible side, which is exact since the activity of a row with integral coefficients over binary
+ * variables is integral. Return false, leaving the row as is, if it has no small integral scaling.
+ */
+static bool scale_row_integral(const BPRow* row, vector<double>& coeffs, double& rhs, RowSense& sense)
+{
+	double scale = find_row_scale(row);
+	if (scale == 0 || !isfinite(row->rhs)) {
+		return false;
+	}
+	bool negate = (row->nnonz > 0);
+	for (int j = 0; j < row->nnonz; ++j) {
+		negate = negate && row->coeffs[j] < 0;
+	}
+	if (negate) {
+		scale = -scale;
+	}
+
+	coeffs.resize(row->nnonz);
+	for (int j = 0; j < row->nnonz; ++j) {
+		coeffs[j] = round(row->coeffs[j] * scale);
+		if (!is_small_integer(coeffs[j])) {
+			return false;
+		}
+	}
+	sense = negate ? ((row->sense == SENSE_LE) ? SENSE_GE : SENSE_LE) : row->sense;
+	double scaled_rhs = row->rhs * scale;
+	double tol = BP_INTEGRAL_TOL * MAX(1, fabs(scaled_rhs));
+	rhs = (sense == SENSE_LE) ? floor(scaled_rhs + tol) : ceil(scaled_rhs - tol);
+	return is_small_integer(rhs);
+}
+
+
+void BPMatrix::init(const vector<BPVar*>& vars, const vector<BPRow*>& rows)
+{
+	nrows = rows.size();
+	ncols = vars.size();
+
+	// Rows
+	long nnonz = 0;
+	for (BPRow* row : rows) {
+		nnonz += row->nnonz;
+	}
+	if (nnonz > INT32_MAX) {
+		cout << "Error: Too many nonzeros in constraint matrix" << endl;
+		exit(1);
+	}
+
+	row_start.resize(nrows + 1);
+	row_ind.resize(nnonz);
+	row_coeffs.resize(nnonz);
+	row_sense.resize(nrows);
+	row_rhs.resize(nrows);
+	row_class.resize(nrows);
+	row_max_coeff.resize(nrows);
+	vector<int32_t> col_nnonz(ncols, 0);
+	vector<double> scaled_coeffs;
+	double rhs_bound = 0;
+	bool all_integral = true;
+	int k = 0;
+	for (int i = 0; i < nrows; ++i) {
+		BPRow* row = rows[i];
+		row_start[i] = k;
+
+		// Integral rows are stored scaled, general rows as they are
+		double rhs;
+		RowSense sense;
+		bool integral = scale_row_integral(row, scaled_coeffs, rhs, sense);
+		const double* coeffs = integral ? scaled_coeffs.data() : row->coeffs.data();
+		row_sense[i] = integral ? sense : row->sense;
+		row_rhs[i] = integral ? rhs : row->rhs;
+		bool unit = integral;
+		double abs_sum = 0;
+		row_max_coeff[i] = 0;
+		for (int j = 0; j < row->nnonz; ++j) {
+			assert(row->ind[j] >= 0 && row->ind[j] < ncols);
+			row_ind[k] = row->ind[j];
+			row_coeffs[k] = coeffs[j];
+			col_nnonz[row->ind[j]]++;
+			k++;
+			unit = unit && coeffs[j] == 1;
+			abs_sum += fabs(coeffs[j]);
+			row_max_coeff[i] = MAX(row_max_coeff[i], fabs(coeffs[j]));
+		}
+		row_class[i] = unit ? ROW_UNIT : (integral ? ROW_INTEGRAL : ROW_GENERAL);
+
+		// A state rhs starts at the row rhs and moves by at most the sum of the coefficients when variables are set, and
+		// by as much again when merges revert them, or is set to an activity bound
+		all_integral = all_integral && integral;
+		rhs_bound = MAX(rhs_bound, fabs(row_rhs[i]) + 2 * abs_sum);
+	}
+	row_start[nrows] = k;
+
+	if (!all_integral || rhs_bound > INT32_MAX) {
+		rhs_type = RHS_DOUBLE;
+	} else if (rhs_bound > INT16_MAX) {
+		rhs_type = RHS_INT32;
+	} else {
+		rhs_type = RHS_INT16;
+	}
+
+	// Columns, by a counting pass over the rows; nonzeros of a variable are ordered by row
+	col_start.resize(ncols + 1);
+	col_start[0] = 0;
+	for (int j = 0; j < ncols; ++j) {
+		col_start[j + 1] = col_start[j] + col_nnonz[j];
+	}
+	col_ind.resize(nnonz);
+	col_coeffs.resize(nnonz);
+	vector<int32_t> col_pos(col_start.begin(), col_start.end() - 1);
+	for (int i = 0; i < nrows; ++i) {
+		for (int k = row_start[i]; k < row_start[i + 1]; ++k) {
+			int pos = col_pos[row_ind[k]]++;
+			col_ind[pos] = i;
+			col_coeffs[pos] = row_coeffs[k];
+		}
+	}
+}
@@ -0,0 +1,83 @@
+/**
+ * Constraint matrix for binary problems
+ */
+
+#ifndef BP_MATRIX_HPP_
+#define BP_MATRIX_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "bpvar.hpp"
+#include "bprow.hpp"
+#include "bp_rhs.hpp"
+
+using namespace std;
+
+
+/**
+ * Class of a row by its coefficients, which selects the kernels that update and propagate it. Activities and right-hand
+ * sides of unit and integral rows are integers, held exactly in doubles, so they are compared without tolerance. Rows
+ * whose coefficients become integral when multiplied by a small factor are stored scaled (see BPMatrix::init).
+ */
+enum BPRowClass {
+	ROW_UNIT = 0,     /**< all coefficients 1 and an integral rhs: set packing, set covering and cardinality rows */
+	ROW_INTEGRAL,     /**< integral coefficients and rhs, such as knapsack rows */
+	ROW_GENERAL       /**< any other row */
+};
+
+
+/**
+ * Constraint matrix of a binary program stored contiguously, both by row (CSR) and by column (CSC), so that the rows of
+ * a variable and the variables of a row are scanned without following pointers. Nonzeros of row i are at positions
+ * row_start[i] to row_start[i + 1] - 1 of row_ind and row_coeffs; nonzeros of variable j are at positions col_start[j]
+ * to col_start[j + 1] - 1 of col_ind and col_coeffs. Built once from the rows and variables of an instance; a row may
+ * be stored as an equivalent scaled row with integral coefficients and rhs, so only the matrix is used to build states.
+ */
+class BPMatrix
+{
+public:
+	int                nrows;
+	int                ncols;
+
+	// Row-major storage
+	vector<int32_t>    row_start;         /**< position of the first nonzero of each row, plus the number of nonzeros */
+	vector<int32_t>    row_ind;           /**< variable of each nonzero, ordered by row */
+	vector<double>     row_coeffs;        /**< coefficient of each nonzero, ordered by row */
+	vector<RowSense>   row_sense;         /**< sense of each row */
+	vector<double>     row_rhs;           /**< right-hand side of each row */
+	vector<BPRowClass> row_class;         /**< class of each row, set at construction */
+	vector<double>     row_max_coeff;     /**< largest absolute value of a coefficient of each row */
+	BPRhsType          rhs_type;          /**< type in which states store right-hand sides; integral if no row is general */
+
+	// Column-major storage
+	vector<int32_t>    col_start;         /**< position of the first nonzero of each variable, plus the number of nonzeros */
+	vector<int32_t>    col_ind;           /**< row of each nonzero, ordered by variable */
+	vector<double>     col_coeffs;        /**< coefficient of each nonzero, ordered by variable */
+
+	BPMatrix() : nrows(0), ncols(0), rhs_type(RHS_DOUBLE) {}
+
+	/** Build the matrix from the rows of an instance over the given variables */
+	void init(const vector<BPVar*>& vars, const vector<BPRow*>& rows);
+
+	/** Number of rows of a class */
+	int get_nrows_class(BPRowClass cls) const
+	{
+		return count(row_class.begin(), row_class.end(), cls);
+	}
+
+	/** Number of nonzeros of a row */
+	int get_row_nnonz(int row) const
+	{
+		return row_start[row + 1] - row_start[row];
+	}
+
+	/** Number of nonzeros of a variable */
+	int get_col_nnonz(int col) const
+	{
+		return col_start[col + 1] - col_start[col];
+	}
+};
+
+
+#endif /* BP_MATRIX_HPP_ */
@@ -41,6 +41,11 @@ struct CuthillMcKeePairOrdering : Ordering {
 		return v_in_layer[layer];
 	}
 
+	bool is_static()
+	{
+		return true;
+	}
+
 private:
 
 	void construct_ordering();
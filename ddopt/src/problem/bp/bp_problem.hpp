@@ -14,6 +14,7 @@
 class BinaryProblem : public Problem
 {
 public:
+	typedef BPState StateType;
 
 	vector<double>   minactivity;         /**< lower bound on activity per row */
 	vector<double>   maxactivity;         /**< upper bound on activity per row */
@@ -29,7 +30,7 @@ public:
 
 		// Wrap propagators in a multipass propagator
 		if (!_propagators.empty()) {
-			propagator = new BPPropMultipass(_propagators);
+			propagator = new BPPropMultipass(_propagators, _opts->bp_prop_budget);
 		} else {
 			propagator = NULL;
 		}
@@ -45,8 +46,9 @@ public:
 
 	BPState* create_initial_state()
 	{
-		BPState* state = new BPState(instance->nvars, instance->nrows);
-		state->init_state_from_rows(instance->rows);
+		BPState* state = new BPState(instance->nvars, instance->nrows, instance->matrix.rhs_type);
+		state->init_state_from_matrix(instance->matrix);
+		state->retire_rows(instance->first_open_row);
 		return state;
 	}
 
@@ -58,10 +60,12 @@ public:
 
 inline void BinaryProblem::cb_initialize()
 {
-	minactivity.resize(instance->nrows, 0.0);
-	maxactivity.resize(instance->nrows, 0.0);
+	minactivity.assign(instance->nrows, 0.0);
+	maxactivity.assign(instance->nrows, 0.0);
+	const BPMatrix& matrix = instance->matrix;
 	for (int i = 0; i < instance->nrows; ++i) {
-		for (double coeff : instance->rows[i]->coeffs) {
+		for (int k = matrix.row_start[i]; k < matrix.row_start[i + 1]; ++k) {
+			double coeff = matrix.row_coeffs[k];
 			minactivity[i] += MIN(0, coeff); /* minimum between possible evaluations of term a_k * x_k */
 			maxactivity[i] += MAX(0, coeff); /* maximum between possible evaluations of term a_k * x_k */
 		}
@@ -70,15 +74,16 @@ inline void BinaryProblem::cb_initialize()
 
 inline bool BinaryProblem::cb_skip_var_for_long_arc(int var, State* state)
 {
-	BPState* state_bp = dynamic_cast<BPState*>(state);
+	BPState* state_bp = static_cast<BPState*>(state);
 
 	// all variables from previous layers must be set to DOM_PROCESSED
 	// if the variable has domain {0}, the node will be skipped and relevant arcs will be long arcs
 	bool skip_var = (state_bp->domains[var] == DOM_ZERO);
 
-	// If variable is to be skipped, mark it as processed
+	// If variable is to be skipped, mark it as processed and retire the rows it ends, as a transition would
 	if (skip_var) {
 		state_bp->mark_as_processed(var);
+		state_bp->retire_rows(instance->var_first_open_row[var]);
 	}
 
 	return skip_var;
@@ -87,11 +92,10 @@ inline bool BinaryProblem::cb_skip_var_for_long_arc(int var, State* state)
 inline void BinaryProblem::cb_layer_end(int current_var)
 {
 	/* update minactivity and maxactivity */
-	BPVar* var = instance->vars[current_var];
-	int nrows = var->rows.size();
-	for (int i = 0; i < nrows; ++i) {
-		int cons = var->rows[i];
-		double coeff = var->row_coeffs[i];
+	const BPMatrix& matrix = instance->matrix;
+	for (int k = matrix.col_start[current_var]; k < matrix.col_start[current_var + 1]; ++k) {
+		int cons = matrix.col_ind[k];
+		double coeff = matrix.col_coeffs[k];
 
 		if (coeff < 0) {
 			minactivity[cons] -= coeff;
@@ -5,26 +5,130 @@
 #ifndef BP_PROP_HPP_
 #define BP_PROP_HPP_
 
-#include <unordered_set>
+#include <vector>
+#include <atomic>
 #include "bp_state.hpp"
-#include "bprow.hpp"
-#include "bpvar.hpp"
+#include "bp_matrix.hpp"
+
+using namespace std;
+
+
+/**
+ * Worklist of a propagation: variables fixed and not yet propagated, and rows to scan. A row is queued when the activity
+ * or right-hand side of the row changes, that is, when one of its variables is fixed, and is not queued twice before it
+ * is scanned. Worklists are reused across propagations (one per thread, see bp_prop_worklist), so that a propagation
+ * does not allocate; rows queued are tracked by stamping them with the epoch of the propagation.
+ */
+class BPPropWorklist
+{
+	unsigned          epoch = 0;
+	vector<unsigned>  row_stamp;          /**< epoch at which each row was queued; cleared when the row is taken */
+	vector<int>       row_queue;
+	int               row_head = 0;       /**< next row to take from row_queue */
+	vector<int>       var_queue;
+	int               var_head = 0;       /**< next variable to take from var_queue */
+
+public:
+
+	/** Start a new propagation over an instance with nrows rows, emptying the worklist */
+	void start(int nrows)
+	{
+		if ((int) row_stamp.size() < nrows) {
+			row_stamp.resize(nrows, 0);
+		}
+		if (++epoch == 0) {
+			fill(row_stamp.begin(), row_stamp.end(), 0);
+			epoch = 1;
+		}
+		row_queue.clear();
+		row_head = 0;
+		var_queue.clear();
+		var_head = 0;
+	}
+
+	/** Add a variable whose domain was fixed; its rows are queued once the rows queued before are taken */
+	void push_var(int var)
+	{
+		var_queue.push_back(var);
+	}
+
+	/** Number of variables added since the propagation started */
+	int get_nvars_pushed() const
+	{
+		return var_queue.size();
+	}
+
+	/** Take the next row to scan into row; return false if the worklist is empty (a fixpoint is reached) */
+	bool pop_row(const BPMatrix& matrix, int& row)
+	{
+		while (row_head == (int) row_queue.size()) {
+			if (var_head == (int) var_queue.size()) {
+				return false;
+			}
+			row_queue.clear();
+			row_head = 0;
+			int var = var_queue[var_head++];
+			for (int k = matrix.col_start[var]; k < matrix.col_start[var + 1]; ++k) {
+				int cons = matrix.col_ind[k];
+				if (row_stamp[cons] != epoch) {
+					row_stamp[cons] = epoch;
+					row_queue.push_back(cons);
+				}
+			}
+		}
+		row = row_queue[row_head++];
+		row_stamp[row] = 0;
+		return true;
+	}
+};
+
+/** Propagation worklist of the calling thread */
+inline BPPropWorklist& bp_prop_worklist()
+{
+	static thread_local BPPropWorklist worklist;
+	return worklist;
+}
 
 
 /** Interface for propagator for binary programs. Propagates constraints on domains used as states for BDDs. */
 class BPProp
 {
 public:
+	BPProp() : nrows_scanned(0), nfixings(0) {}
+
 	virtual ~BPProp() {}
 
 	/**
-	 * Run propagation over the given state where v is a newly fixed variable.
+	 * Run propagation over the given row of the state, whose activity or right-hand side changed. The given minactivity
+	 * and maxactivity are those of the rows over unprocessed variables; see BPState::get_minactivity for the ones of the
+	 * state. Variables fixed must be added to the worklist.
 	 * Store in infeasible whether infeasibility was detected during propagation.
-	 * Propagation may optionally add more fixed variables to fixed_vars_next to support further passes on these variables.
 	 */
-	virtual void propagate(BPState* state, int v, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-	                       vector<double>& minactivity, vector<double>& maxactivity, bool& infeasible, unordered_set<int>& fixed_vars_next) = 0;
+	virtual void propagate_row(BPState* state, int row, const BPMatrix& matrix, const vector<double>& minactivity,
+	                           const vector<double>& maxactivity, BPPropWorklist& worklist, bool& infeasible) = 0;
+
+	/** Number of rows scanned by this propagator */
+	long get_nrows_scanned() const
+	{
+		return nrows_scanned;
+	}
+
+	/** Number of variables fixed by this propagator */
+	long get_nfixings() const
+	{
+		return nfixings;
+	}
+
+	/** Add the counts of a propagation; called once per propagation rather than per row, as threads share propagators */
+	void add_counts(long rows_scanned, long fixings)
+	{
+		nrows_scanned.fetch_add(rows_scanned, memory_order_relaxed);
+		nfixings.fetch_add(fixings, memory_order_relaxed);
+	}
 
+private:
+	atomic<long>  nrows_scanned;
+	atomic<long>  nfixings;
 };
 
 #endif // BP_PROP_HPP_
@@ -0,0 +1,550 @@
+/**
+ * Generator of a BP instance off an MPS file
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include <unordered_map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bp_reader_mps.hpp"
+#include "../../util/util.hpp"
+
+#define MPS_INFINITY     1e20   /* bounds of at least this magnitude are infinite, as in CPLEX */
+#define MPS_MAX_TOKENS   6      /* fields read per line; an MPS data line has at most six */
+
+
+/** Sections of an MPS file */
+enum MPSSection {
+	MPS_NONE,
+	MPS_OBJSENSE,
+	MPS_ROWS,
+	MPS_COLUMNS,
+	MPS_RHS,
+	MPS_RANGES,
+	MPS_BOUNDS,
+	MPS_END
+};
+
+/** Field of a line of the file; not null-terminated */
+struct MPSToken {
+	const char* str;
+	int         len;
+
+	bool operator==(const char* other) const
+	{
+		return (int) strlen(other) == len && strncmp(str, other, len) == 0;
+	}
+
+	string to_string() const
+	{
+		return string(str, len);
+	}
+};
+
+/** Constraint (or objective) row as declared in the file */
+struct MPSRow {
+	char      type;           /**< N, L, G or E */
+	bool      excluded;       /**< excluded by the filter */
+	double    rhs;
+	double    range;
+	bool      has_range;
+};
+
+/** Column as declared in the file */
+struct MPSCol {
+	double    obj;
+	double    lb;
+	double    ub;
+	bool      excluded;       /**< excluded by the filter */
+};
+
+
+/** State of the parser; all nonzeros are kept in file order until the instance is built */
+class MPSReader
+{
+public:
+	MPSReader(const string& _filename, BPReaderFilter* _filter) : filename(_filename), filter(_filter) {}
+
+	/** Parse the given contents of the file */
+	void parse(const char* data, size_t size);
+
+	/** Build the instance from the parsed file */
+	BPInstance* create_instance();
+
+private:
+	string                          filename;
+	BPReaderFilter*                 filter;
+	int                             line_number = 0;
+
+	MPSSection                      section = MPS_NONE;
+	bool                            maximize = false;
+	int                             obj_row = -1;          /**< first N row, which is the objective */
+
+	vector<MPSRow>                  rows;
+	vector<string>                  row_names;
+	unordered_map<string, int>      row_index;
+	vector<MPSCol>                  cols;
+	vector<string>                  col_names;
+	unordered_map<string, int>      col_index;
+	int                             last_col = -1;         /**< column of the last COLUMNS line */
+
+	vector<int>                     nonz_row;              /**< nonzeros of constraint rows, in file order */
+	vector<int>                     nonz_col;
+	vector<double>                  nonz_coeff;
+
+	void parse_line(MPSToken* tokens, int ntokens, bool header);
+	void parse_column(MPSToken* tokens, int ntokens);
+	void parse_rhs_or_range(MPSToken* tokens, int ntokens, bool is_range);
+	void parse_bound(MPSToken* tokens, int ntokens);
+
+	int find_row(const MPSToken& token);
+	int find_col(const MPSToken& token);
+	double parse_value(const MPSToken& token);
+
+	void error(const string& message)
+	{
+		cout << "Error: " << filename << ", line " << line_number << ": " << message << endl;
+		exit(1);
+	}
+};
+
+
+void MPSReader::parse(const char* data, size_t size)
+{
+	MPSToken tokens[MPS_MAX_TOKENS];
+	const char* end = data + size;
+	const char* p = data;
+
+	while (p < end && section != MPS_END) {
+		const char* eol = (const char*) memchr(p, '\n', end - p);
+		if (eol == NULL) {
+			eol = end;
+		}
+		line_number++;
+
+		// Section headers start at the first column; comment lines start with '*'
+		if (p < eol && *p != '*') {
+			bool header = (*p != ' ' && *p != '\t');
+			int ntokens = 0;
+			const char* q = p;
+			while (q < eol) {
+				while (q < eol && (*q == ' ' || *q == '\t' || *q == '\r')) {
+					q++;
+				}
+				if (q == eol) {
+					break;
+				}
+				const char* token_start = q;
+				while (q < eol && *q != ' ' && *q != '\t' && *q != '\r') {
+					q++;
+				}
+				if (ntokens == MPS_MAX_TOKENS) {
+					error("Too many fields");
+				}
+				tokens[ntokens].str = token_start;
+				tokens[ntokens].len = q - token_start;
+				ntokens++;
+			}
+			if (ntokens > 0) {
+				parse_line(tokens, ntokens, header);
+			}
+		}
+
+		p = eol + 1;
+	}
+
+	if (section != MPS_END) {
+		error("Missing ENDATA");
+	}
+	if (obj_row < 0) {
+		error("Missing objective row");
+	}
+}
+
+
+void MPSReader::parse_line(MPSToken* tokens, int ntokens, bool header)
+{
+	if (header) {
+		if (tokens[0] == "NAME") {
+			section = MPS_NONE;
+		} else if (tokens[0] == "OBJSENSE") {
+			section = MPS_OBJSENSE;
+			if (ntokens > 1) { // free MPS may have the sense in the header
+				parse_line(tokens + 1, ntokens - 1, false);
+			}
+		} else if (tokens[0] == "ROWS") {
+			section = MPS_ROWS;
+		} else if (tokens[0] == "COLUMNS") {
+			section = MPS_COLUMNS;
+		} else if (tokens[0] == "RHS") {
+			section = MPS_RHS;
+		} else if (tokens[0] == "RANGES") {
+			section = MPS_RANGES;
+		} else if (tokens[0] == "BOUNDS") {
+			section = MPS_BOUNDS;
+		} else if (tokens[0] == "ENDATA") {
+			section = MPS_END;
+		} else {
+			error("Unsupported section " + tokens[0].to_string());
+		}
+		return;
+	}
+
+	switch (section) {
+	case MPS_OBJSENSE:
+		if (tokens[0] == "MAX" || tokens[0] == "MAXIMIZE") {
+			maximize = true;
+		} else if (tokens[0] == "MIN" || tokens[0] == "MINIMIZE") {
+			maximize = false;
+		} else {
+			error("Invalid objective sense");
+		}
+		break;
+	case MPS_ROWS: {
+		if (ntokens != 2 || tokens[0].len != 1 || strchr("NLGE", tokens[0].str[0]) == NULL) {
+			error("Invalid row");
+		}
+		string name = tokens[1].to_string();
+		if (row_index.count(name) > 0) {
+			error("Duplicate row " + name);
+		}
+		MPSRow row;
+		row.type = tokens[0].str[0];
+		row.excluded = (row.type != 'N' && filter != NULL && filter->exclude_cons(name));
+		row.rhs = 0;
+		row.range = 0;
+		row.has_range = false;
+		if (row.type == 'N' && obj_row < 0) {
+			obj_row = rows.size();
+		}
+		row_index[name] = rows.size();
+		rows.push_back(row);
+		row_names.push_back(name);
+		break;
+	}
+	case MPS_COLUMNS:
+		parse_column(tokens, ntokens);
+		break;
+	case MPS_RHS:
+		parse_rhs_or_range(tokens, ntokens, false);
+		break;
+	case MPS_RANGES:
+		parse_rhs_or_range(tokens, ntokens, true);
+		break;
+	case MPS_BOUNDS:
+		parse_bound(tokens, ntokens);
+		break;
+	default:
+		error("Data outside of a section");
+	}
+}
+
+
+void MPSReader::parse_column(MPSToken* tokens, int ntokens)
+{
+	// Integrality markers are skipped: all variables are taken as binary
+	if (ntokens >= 2 && tokens[1] == "'MARKER'") {
+		return;
+	}
+	if (ntokens != 3 && ntokens != 5) {
+		error("Invalid column entry");
+	}
+
+	// Entries of a column are usually consecutive, which avoids a lookup per line
+	if (last_col < 0 || !(tokens[0] == col_names[last_col].c_str())) {
+		string name = tokens[0].to_string();
+		unordered_map<string, int>::iterator it = col_index.find(name);
+		if (it != col_index.end()) {
+			last_col = it->second;
+		} else {
+			MPSCol col;
+			col.obj = 0;
+			col.lb = 0;
+			col.ub = numeric_limits<double>::infinity();
+			col.excluded = (filter != NULL && filter->exclude_var(name));
+			last_col = cols.size();
+			col_index[name] = cols.size();
+			cols.push_back(col);
+			col_names.push_back(name);
+		}
+	}
+
+	for (int i = 1; i < ntokens; i += 2) {
+		int row = find_row(tokens[i]);
+		double coeff = parse_value(tokens[i + 1]);
+		if (row == obj_row) {
+			cols[last_col].obj = coeff;
+		} else if (rows[row].type != 'N' && !rows[row].excluded) {
+			nonz_row.push_back(row);
+			nonz_col.push_back(last_col);
+			nonz_coeff.push_back(coeff);
+		}
+	}
+}
+
+
+void MPSReader::parse_rhs_or_range(MPSToken* tokens, int ntokens, bool is_range)
+{
+	// The name of the right-hand side or range vector is optional in free MPS
+	int first = (ntokens % 2 == 1) ? 1 : 0;
+	if (ntokens - first != 2 && ntokens - first != 4) {
+		error(is_range ? "Invalid range entry" : "Invalid right-hand side entry");
+	}
+
+	for (int i = first; i < ntokens; i += 2) {
+		MPSRow& row = rows[find_row(tokens[i])];
+		double value = parse_value(tokens[i + 1]);
+		if (row.type == 'N') {
+			continue; // objective constant, or a free row
+		}
+		if (is_range) {
+			row.range = value;
+			row.has_range = true;
+		} else {
+			row.rhs = value;
+		}
+	}
+}
+
+
+void MPSReader::parse_bound(MPSToken* tokens, int ntokens)
+{
+	// Bound types with a value are followed by the (optional in free MPS) bound vector name, column and value
+	const MPSToken& type = tokens[0];
+	bool has_value = (type == "UP" || type == "LO" || type == "FX" || type == "LI" || type == "UI");
+	int col_pos;
+	if (has_value) {
+		if (ntokens != 3 && ntokens != 4) {
+			error("Invalid bound entry");
+		}
+		col_pos = ntokens - 2;
+	} else if (type == "BV" && ntokens == 4) {
+		col_pos = 2;
+	} else {
+		if (ntokens != 2 && ntokens != 3) {
+			error("Invalid bound entry");
+		}
+		col_pos = ntokens - 1;
+	}
+
+	MPSCol& col = cols[find_col(tokens[col_pos])];
+	double value = has_value ? parse_value(tokens[col_pos + 1]) : 0;
+	if (type == "UP" || type == "UI") {
+		col.ub = value;
+	} else if (type == "LO" || type == "LI") {
+		col.lb = value;
+	} else if (type == "FX") {
+		col.lb = value;
+		col.ub = value;
+	} else if (type == "BV") {
+		col.lb = 0;
+		col.ub = 1;
+	} else if (type == "FR") {
+		col.lb = -numeric_limits<double>::infinity();
+		col.ub = numeric_limits<double>::infinity();
+	} else if (type == "MI") {
+		col.lb = -numeric_limits<double>::infinity();
+	} else if (type == "PL") {
+		col.ub = numeric_limits<double>::infinity();
+	} else {
+		error("Unsupported bound type " + type.to_string());
+	}
+}
+
+
+int MPSReader::find_row(const MPSToken& token)
+{
+	unordered_map<string, int>::iterator it = row_index.find(token.to_string());
+	if (it == row_index.end()) {
+		error("Unknown row " + token.to_string());
+	}
+	return it->second;
+}
+
+
+int MPSReader::find_col(const MPSToken& token)
+{
+	unordered_map<string, int>::iterator it = col_index.find(token.to_string());
+	if (it == col_index.end()) {
+		error("Unknown column " + token.to_string());
+	}
+	return it->second;
+}
+
+
+double MPSReader::parse_value(const MPSToken& token)
+{
+	char buffer[64];
+	if (token.len >= (int) sizeof(buffer)) {
+		error("Invalid number " + token.to_string());
+	}
+	memcpy(buffer, token.str, token.len);
+	buffer[token.len] = '\0';
+	char* end;
+	double value = strtod(buffer, &end);
+	if (end != buffer + token.len) {
+		error("Invalid number " + token.to_string());
+	}
+	if (value >= MPS_INFINITY) {
+		return numeric_limits<double>::infinity();
+	}
+	if (value <= -MPS_INFINITY) {
+		return -numeric_limits<double>::infinity();
+	}
+	return value;
+}
+
+
+BPInstance* MPSReader::create_instance()
+{
+	int ncols = cols.size();
+	int nrows = rows.size();
+
+	// Create BPVars; we maximize
+	vector<BPVar*> vars_in_bdd;
+	vector<int> var_of_col(ncols, -1);
+	vector<bool> fixed(ncols, false);
+	for (int j = 0; j < ncols; ++j) {
+		MPSCol& col = cols[j];
+		if (col.excluded) {
+			continue;
+		}
+		if (col.lb < 0 || col.ub > 1 || col.lb > col.ub || (DBL_EQ(col.lb, col.ub) && !DBL_EQ(col.lb, 0)
+		        && !DBL_EQ(col.lb, 1))) {
+			cout << "Error: Variable " << col_names[j] << " is not binary" << endl;
+			exit(1);
+		}
+		fixed[j] = DBL_EQ(col.lb, col.ub);
+		var_of_col[j] = vars_in_bdd.size();
+		vars_in_bdd.push_back(new BPVar(maximize ? col.obj : -col.obj, vars_in_bdd.size()));
+	}
+
+	// Group nonzeros by row, keeping the order of columns
+	vector<int> row_start(nrows + 1, 0);
+	for (int row : nonz_row) {
+		row_start[row + 1]++;
+	}
+	for (int i = 0; i < nrows; ++i) {
+		row_start[i + 1] += row_start[i];
+	}
+	vector<int> row_nonz(nonz_row.size());
+	vector<int> row_pos(row_start.begin(), row_start.end() - 1);
+	for (int k = 0; k < (int) nonz_row.size(); ++k) {
+		row_nonz[row_pos[nonz_row[k]]++] = k;
+	}
+
+	// Create BPRows; ranged and equality constraints give one row per side, as in read_bp_instance_cplex_mps
+	vector<BPRow*> rows_in_bdd;
+	vector<double> coeffs;
+	vector<int> ind;
+	for (int i = 0; i < nrows; ++i) {
+		MPSRow& row = rows[i];
+		if (row.type == 'N' || row.excluded) {
+			continue;
+		}
+
+		double lb = (row.type == 'L') ? -numeric_limits<double>::infinity() : row.rhs;
+		double ub = (row.type == 'G') ? numeric_limits<double>::infinity() : row.rhs;
+		if (row.has_range) {
+			if (row.type == 'G' || (row.type == 'E' && row.range > 0)) {
+				ub = row.rhs + fabs(row.range);
+			} else {
+				lb = row.rhs - fabs(row.range);
+			}
+		}
+
+		// Take variables that are not fixed and move those that are to the right-hand side
+		double fixed_activity = 0;
+		coeffs.clear();
+		ind.clear();
+		for (int p = row_start[i]; p < row_start[i + 1]; ++p) {
+			int k = row_nonz[p];
+			int col = nonz_col[k];
+			if (cols[col].excluded) {
+				cout << "Error: Excluded variable " << col_names[col] << " is in constraint " << row_names[i] << endl;
+				exit(1);
+			}
+			if (fixed[col]) {
+				fixed_activity += nonz_coeff[k] * cols[col].lb;
+			} else {
+				coeffs.push_back(nonz_coeff[k]);
+				ind.push_back(var_of_col[col]);
+			}
+		}
+
+		if (lb != -numeric_limits<double>::infinity()) {
+			BPRow* bprow = new BPRow(SENSE_GE, lb - fixed_activity, coeffs, ind);
+			if (bprow->nnonz > 0 && DBL_GT(bprow->rhs, bprow->calculate_minactivity())) {
+				rows_in_bdd.push_back(bprow);
+			} else {
+				delete bprow;
+			}
+		}
+
+		if (ub != numeric_limits<double>::infinity()) {
+			BPRow* bprow = new BPRow(SENSE_LE, ub - fixed_activity, coeffs, ind);
+			if (bprow->nnonz > 0 && DBL_LT(bprow->rhs, bprow->calculate_maxactivity())) {
+				rows_in_bdd.push_back(bprow);
+			} else {
+				delete bprow;
+			}
+		}
+	}
+
+	// A fixed variable is kept fixed by a row of its own, so that the objective accounts for its value
+	for (int j = 0; j < ncols; ++j) {
+		if (var_of_col[j] >= 0 && fixed[j]) {
+			if (DBL_EQ(cols[j].lb, 0)) {
+				rows_in_bdd.push_back(new BPRow(SENSE_LE, 0, vector<double>(1, 1), vector<int>(1, var_of_col[j])));
+			} else {
+				rows_in_bdd.push_back(new BPRow(SENSE_GE, 1, vector<double>(1, 1), vector<int>(1, var_of_col[j])));
+			}
+		}
+	}
+
+	/* Set rows in vars; same as BPVar::init_rows without a search over all rows */
+	for (int i = 0; i < (int) rows_in_bdd.size(); ++i) {
+		BPRow* row = rows_in_bdd[i];
+		for (int j = 0; j < row->nnonz; ++j) {
+			BPVar* var = vars_in_bdd[row->ind[j]];
+			if (var->rows.empty() || var->rows.back() != i) {
+				var->rows.push_back(i);
+				var->row_coeffs.push_back(row->coeffs[j]);
+			}
+		}
+	}
+
+	return new BPInstance(vars_in_bdd, rows_in_bdd);
+}
+
+
+BPInstance* read_bp_instance_mps(string mps_filename, BPReaderFilter* filter /*= NULL*/)
+{
+	int fd = open(mps_filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		cout << "Error: MPS file cannot be opened" << endl;
+		exit(1);
+	}
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+		cout << "Error: MPS file cannot be read" << endl;
+		exit(1);
+	}
+	size_t size = file_stat.st_size;
+	void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		cout << "Error: MPS file cannot be read" << endl;
+		exit(1);
+	}
+	madvise(data, size, MADV_SEQUENTIAL);
+
+	MPSReader reader(mps_filename, filter);
+	reader.parse((const char*) data, size);
+	munmap(data, size);
+
+	return reader.create_instance();
+}
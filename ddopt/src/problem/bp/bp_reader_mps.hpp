@@ -0,0 +1,40 @@
+/**
+ * Generator of a BP instance off an MPS file
+ */
+
+#ifndef BP_READER_MPS_HPP_
+#define BP_READER_MPS_HPP_
+
+#include <string>
+#include "bpvar.hpp"
+#include "bprow.hpp"
+#include "bp_instance.hpp"
+
+#define NODD_TAG               "nodd" /* tag that indicates that constraint should not be added to the decision diagram 
+                                       * (i.e. if the name of a constraint ends with this string, it will not be considered) */
+
+
+// Note: Error checking is not robust; it is up to the user to ensure consistency
+/** Class to filter out unwanted variables and constraints in problem */
+class BPReaderFilter
+{
+public:
+
+	/** Return true if variable must be excluded from problem */
+	virtual bool exclude_var(string var_name) = 0;
+
+	/** Return true if constraint must be excluded from problem */
+	virtual bool exclude_cons(string cons_name) = 0;
+};
+
+/**
+ * Read instance off a fixed or free MPS file without a solver, in a single pass over the memory-mapped file. Fields are
+ * separated by whitespace, so names cannot contain spaces. The instance is the same as with read_bp_instance_cplex_mps,
+ * except that the objective is negated only for minimization (OBJSENSE MAX is honored) and that fixed variables, which
+ * are replaced by their values in constraints, are also kept fixed by a row of their own. Variables must have bounds
+ * within [0,1].
+ */
+BPInstance* read_bp_instance_mps(string mps_filename, BPReaderFilter* filter = NULL);
+
+
+#endif // BP_READER_MPS_HPP_
@@ -0,0 +1,230 @@
+/**
+ * Right-hand sides of a state for binary problems
+ */
+
+#ifndef BP_RHS_HPP_
+#define BP_RHS_HPP_
+
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "../../util/util.hpp"
+#include "../../util/hash.hpp"
+
+using namespace std;
+
+/** Type in which right-hand sides are stored (see BPMatrix::rhs_type) */
+enum BPRhsType {
+	RHS_DOUBLE = 0,    /**< any value; compared by grid point, as hashed (see round_to_hash_grid) */
+	RHS_INT32,         /**< integral values; compared exactly */
+	RHS_INT16          /**< integral values in a small range; compared exactly */
+};
+
+typedef uint64_t BPRhsWord;
+
+
+/**
+ * Right-hand sides of the rows of a state, packed into words by value type: one double, two 32-bit integers or four
+ * 16-bit integers per word. Integral values are compared word by word, and equality is a single memcmp, since the unused
+ * tail of the last word is zero. Words are only accessed through the value type or as bytes. Only rows from first on are
+ * stored; rows before it are retired (see drop_rows_before).
+ */
+class BPRhs
+{
+	vector<BPRhsWord> words;
+	int               first;      /**< first row stored */
+	int               n;          /**< number of rows */
+	BPRhsType         type;
+
+	static int values_per_word(BPRhsType type)
+	{
+		return (type == RHS_INT16) ? 4 : ((type == RHS_INT32) ? 2 : 1);
+	}
+
+	/** Move the values of the rows from new_first on to the start of the words, and zero the tail */
+	template <typename T>
+	void shift_values(int new_first)
+	{
+		T* vals = values<T>();
+		int nkept = n - new_first;
+		memmove(vals, vals + (new_first - first), nkept * sizeof(T));
+		int nwords = (nkept + values_per_word(type) - 1) / values_per_word(type);
+		memset(vals + nkept, 0, nwords * sizeof(BPRhsWord) - nkept * sizeof(T));
+		words.resize(nwords);
+	}
+
+	template <typename T>
+	T* values()
+	{
+		return reinterpret_cast<T*>(words.data());
+	}
+
+	template <typename T>
+	const T* values() const
+	{
+		return reinterpret_cast<const T*>(words.data());
+	}
+
+	/** Lexicographic comparison of integral values: find the first word that differs, then the value within it */
+	template <typename T>
+	int compare_exact(const BPRhs& other) const
+	{
+		const int per_word = sizeof(BPRhsWord) / sizeof(T);
+		const T* a = values<T>();
+		const T* b = other.values<T>();
+		int nwords = words.size();
+		for (int w = 0; w < nwords; ++w) {
+			if (memcmp(a + w * per_word, b + w * per_word, sizeof(BPRhsWord)) != 0) {
+				for (int i = w * per_word; ; ++i) {
+					if (a[i] != b[i]) {
+						return (a[i] < b[i]) ? -1 : 1;
+					}
+				}
+			}
+		}
+		return 0;
+	}
+
+public:
+
+	BPRhs() : first(0), n(0), type(RHS_DOUBLE) {}
+
+	/** Set the number of values and their type; all values are zero */
+	void init(int _n, BPRhsType _type)
+	{
+		first = 0;
+		n = _n;
+		type = _type;
+		words.assign((n + values_per_word(type) - 1) / values_per_word(type), 0);
+	}
+
+	double operator[](int i) const
+	{
+		assert(i >= first && i < n);
+		i -= first;
+		switch (type) {
+		case RHS_INT16:
+			return values<int16_t>()[i];
+		case RHS_INT32:
+			return values<int32_t>()[i];
+		default:
+			return values<double>()[i];
+		}
+	}
+
+	/** Set value i; integral types require an integral value in their range */
+	void set(int i, double val)
+	{
+		assert(i >= first && i < n);
+		i -= first;
+		switch (type) {
+		case RHS_INT16:
+			assert(val == floor(val) && val >= INT16_MIN && val <= INT16_MAX);
+			values<int16_t>()[i] = (int16_t) val;
+			break;
+		case RHS_INT32:
+			assert(val == floor(val) && val >= INT32_MIN && val <= INT32_MAX);
+			values<int32_t>()[i] = (int32_t) val;
+			break;
+		default:
+			values<double>()[i] = val;
+			break;
+		}
+	}
+
+	/** Number of rows, including retired ones */
+	int size() const
+	{
+		return n;
+	}
+
+	/** First row that is not retired */
+	int get_first() const
+	{
+		return first;
+	}
+
+	/** Retire the rows before new_first; their values are no longer stored */
+	void drop_rows_before(int new_first)
+	{
+		assert(new_first >= first && new_first <= n);
+		switch (type) {
+		case RHS_INT16:
+			shift_values<int16_t>(new_first);
+			break;
+		case RHS_INT32:
+			shift_values<int32_t>(new_first);
+			break;
+		default:
+			shift_values<double>(new_first);
+			break;
+		}
+		first = new_first;
+	}
+
+	BPRhsType get_type() const
+	{
+		return type;
+	}
+
+	/** Bytes allocated outside of the object itself */
+	size_t get_allocated_bytes() const
+	{
+		return words.capacity() * sizeof(BPRhsWord);
+	}
+
+	/** Return true if the same rows are retired and all values are the same as in other, by grid point for doubles */
+	bool equals_to(const BPRhs& other) const
+	{
+		assert(n == other.n && type == other.type);
+		if (first != other.first) {
+			return false;
+		}
+		if (type != RHS_DOUBLE) {
+			return memcmp(words.data(), other.words.data(), words.size() * sizeof(BPRhsWord)) == 0;
+		}
+		const double* a = values<double>();
+		const double* b = other.values<double>();
+		for (int i = 0; i < n - first; ++i) {
+			if (round_to_hash_grid(a[i]) != round_to_hash_grid(b[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * Return a negative, zero or positive value as the values are lexicographically less than, equal to or greater than
+	 * other; values with more rows retired come first
+	 */
+	int compare(const BPRhs& other) const
+	{
+		assert(n == other.n && type == other.type);
+		if (first != other.first) {
+			return other.first - first;
+		}
+		switch (type) {
+		case RHS_INT16:
+			return compare_exact<int16_t>(other);
+		case RHS_INT32:
+			return compare_exact<int32_t>(other);
+		default:
+			break;
+		}
+		const double* a = values<double>();
+		const double* b = other.values<double>();
+		for (int i = 0; i < n - first; ++i) {
+			int64_t grid_a = round_to_hash_grid(a[i]);
+			int64_t grid_b = round_to_hash_grid(b[i]);
+			if (grid_a != grid_b) {
+				return (grid_a < grid_b) ? -1 : 1;
+			}
+		}
+		return 0;
+	}
+};
+
+
+#endif /* BP_RHS_HPP_ */
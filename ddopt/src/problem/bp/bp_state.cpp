@@ -6,6 +6,17 @@
 #include "bp_problem.hpp"
 
 State* BPState::transition(Problem* prob, int var, int val)
+{
+	BinaryProblem* prob_bp = dynamic_cast<BinaryProblem*>(prob);
+	if (prob_bp == NULL) {
+		cout << "Error: Using incompatible State and Problem" << endl;
+		exit(1);
+	}
+	return transition(prob_bp, var, val);
+}
+
+
+BPState* BPState::transition(BinaryProblem* prob_bp, int var, int val)
 {
 	// Value must be in domain; otherwise return infeasible
 	if ((val == 0 && domains[var] == DOM_ONE)
@@ -15,33 +26,27 @@ State* BPState::transition(Problem* prob, int var, int val)
 
 	assert(!infeasible);
 
-	BinaryProblem* prob_bp = dynamic_cast<BinaryProblem*>(prob);
-	if (prob_bp == NULL) {
-		cout << "Error: Using incompatible State and Problem" << endl;
-		exit(1);
-	}
-	BPInstance* inst_bp = dynamic_cast<BPInstance*>(prob_bp->inst);
-	if (inst_bp == NULL) {
-		cout << "Error: Using incompatible State and Instance" << endl;
-		exit(1);
-	}
+	BPInstance* inst_bp = prob_bp->instance;
 
 	// Copy state and set variable to value
 	BPState* state = new BPState(*this);
 
-	state->set_var(prob, var, val, inst_bp->vars, inst_bp->rows, prob_bp->minactivity, prob_bp->maxactivity);
+	state->set_var(prob_bp, var, val, inst_bp->matrix, prob_bp->minactivity, prob_bp->maxactivity);
 
 	if (state->infeasible) {
 		return NULL;
 	}
 	assert(state->domains[var] == DOM_PROCESSED);
 
+	// Rows whose last variable is this one are retired
+	state->retire_rows(inst_bp->var_first_open_row[var]);
+
 	return state;
 }
 
 
-void BPState::set_var(Problem* prob, int var, int val, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-                      const vector<double>& init_minactivity, const vector<double>& init_maxactivity)
+void BPState::set_var(BinaryProblem* prob, int var, int val, const BPMatrix& matrix, const vector<double>& minactivity,
+                      const vector<double>& maxactivity)
 {
 	assert(val == 0 || val == 1);
 	assert(!(domains[var] == DOM_ZERO && val == 1));
@@ -57,29 +62,31 @@ void BPState::set_var(Problem* prob, int var, int val, const vector<BPVar*>& var
 	}
 
 	/* otherwise, domain is free, so set the domain and propagate */
-	vector<double> minactivity = init_minactivity;
-	vector<double> maxactivity = init_maxactivity;
-	update_activity_from_domain(vars, minactivity, maxactivity);
-
-	set_domain(var, (val == 0) ? DOM_ZERO : DOM_ONE, vars, rows, minactivity, maxactivity);
+	bind_activity_index(matrix);
+	set_domain(var, (val == 0) ? DOM_ZERO : DOM_ONE, matrix, minactivity, maxactivity);
 	if (infeasible) {
 		return;    /* stop processing when detected infeasibility */
 	}
-	propagate_domain(prob, var, vars, rows, minactivity, maxactivity);
+	propagate_domain(prob, var, matrix, minactivity, maxactivity);
+	if (infeasible) {
+		return;
+	}
+
+	/* same as mark_as_processed, with the state already indexed */
+	remove_activity_deltas(var, matrix);
 	domains.set_domain(var, DOM_PROCESSED);
 }
 
 
-void BPState::propagate_domain(Problem* prob, int var_fixed, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-                               vector<double>& minactivity, vector<double>& maxactivity)
+void BPState::propagate_domain(BinaryProblem* prob, int var_fixed, const BPMatrix& matrix, const vector<double>& minactivity,
+                               const vector<double>& maxactivity)
 {
-	BinaryProblem* prob_bp = dynamic_cast<BinaryProblem*>(prob);
-	if (prob_bp->propagator == NULL) {
+	if (prob->propagator == NULL) {
 		return;
 	}
 
 	bool infeasible_prop = false;
-	prob_bp->propagator->propagate(this, var_fixed, vars, rows, minactivity, maxactivity, infeasible_prop);
+	prob->propagator->propagate(this, var_fixed, matrix, minactivity, maxactivity, infeasible_prop);
 	if (infeasible_prop) {
 		infeasible = true;
 	}
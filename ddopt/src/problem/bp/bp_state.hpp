@@ -15,24 +15,79 @@
 #include "../problem.hpp"
 #include "bp_instance.hpp"
 #include "bp_domains.hpp"
+#include "bp_rhs.hpp"
 
 using namespace std;
 
+class BinaryProblem; // forward declaration
+
+#define BP_DENSE_DELTAS_FRACTION  0.25    /**< fraction of the rows with a delta above which a state keeps dense deltas */
+
+
+/** Change in the activity bounds of a row due to the variables of a state that are set but not processed yet */
+struct BPActivityDelta {
+	int       row;
+	int       nvars;           /**< number of set variables in the row; the delta is dropped (or zero) when none is left */
+	double    min_delta;       /**< added to the minactivity of the row over unprocessed variables */
+	double    max_delta;       /**< added to the maxactivity of the row over unprocessed variables */
+};
+
+
+/**
+ * Position of the activity delta of each row in the state a thread is modifying, so that deltas can be found without a
+ * search. Positions are valid for rows stamped with the current epoch; see BPState::bind_activity_index.
+ */
+struct BPActivityIndex {
+	const State*      state = NULL;   /**< state whose deltas are indexed */
+	unsigned          epoch = 0;
+	vector<unsigned>  stamp;          /**< epoch at which the position of each row was set */
+	vector<int>       pos;            /**< position of the delta of each row in the indexed state */
+};
+
+/** Activity index of the calling thread */
+inline BPActivityIndex& bp_activity_index()
+{
+	static thread_local BPActivityIndex index;
+	return index;
+}
+
+
 /**
  * BDD state for binary programs
  */
-class BPState : public State
+class BPState final : public State
 {
 public:
-	vector<double> rhs;
+	BPRhs rhs;                 /**< right-hand side of each row, stored as integers if the matrix is integral */
 	BPDomains domains;
 	bool infeasible;
+	size_t rhs_hash;           /**< XOR of the hash keys of (row, rhs) pairs; updated at each rhs change */
+
+	/**
+	 * Activity deltas of the rows with a set variable, in no particular order. Activity bounds of the problem account for
+	 * processed variables; these account for the variables set in this state, so that transitions only touch the rows of
+	 * the variables they fix. If dense_deltas is set, there is instead one delta per row, indexed by row.
+	 */
+	vector<BPActivityDelta> activity_deltas;
+
+	/**
+	 * Deltas are stored densely. States switch to dense deltas when more than BP_DENSE_DELTAS_FRACTION of the rows have
+	 * one, where indexing them costs more than copying all rows, and back to sparse deltas below half of that.
+	 */
+	bool dense_deltas;
+	int ndense_deltas;         /**< number of rows with a set variable, if dense */
+
+	/**
+	 * Variables processed since the state was last indexed, whose deltas are still in activity_deltas. Variables skipped
+	 * by long arcs are processed at every node of the pool, so their deltas are only removed if the state is modified.
+	 */
+	vector<int> unindexed_processed_vars;
 
-	/** Constructor */
-	BPState(int nvars, int ncons);
+	/** Constructor; right-hand sides are stored as rhs_type, which must hold all of their values */
+	BPState(int nvars, int ncons, BPRhsType rhs_type);
 
 	/** Empty constructor */
-	BPState() {}
+	BPState() : dense_deltas(false), ndense_deltas(0) {}
 
 	/** Copy constructor */
 	BPState(const BPState& state);
@@ -42,12 +97,33 @@ public:
 
 	State* transition(Problem* prob, int var, int val);
 
+	/** Non-virtual transition used by TypedDDSolver */
+	BPState* transition(BinaryProblem* prob, int var, int val);
+
 	void merge(Problem* prob, State* state);
 
+	State* clone() const
+	{
+		return new BPState(*this);
+	}
+
 	bool equals_to(State* state);
 
+	bool equals_to(BPState* state);
+
 	bool less(const State& state) const;
 
+	size_t hash() const
+	{
+		return rhs_hash ^ domains.hash_val;
+	}
+
+	size_t get_memory_size() const
+	{
+		return sizeof(BPState) + rhs.get_allocated_bytes() + domains.get_allocated_bytes()
+		       + activity_deltas.capacity() * sizeof(BPActivityDelta) + unindexed_processed_vars.capacity() * sizeof(int);
+	}
+
 	std::ostream& stream_write(std::ostream& os) const;
 
 	void print();
@@ -57,9 +133,8 @@ public:
 
 	// Initialization functions
 
-	void init_state(int cons, int cons_rhs);
-	void init_state_from_row(int cons, BPRow* row);
-	void init_state_from_rows(const vector<BPRow*>& rows);
+	void init_state(int cons, double cons_rhs);
+	void init_state_from_matrix(const BPMatrix& matrix);
 
 
 	// State modification functions
@@ -67,77 +142,115 @@ public:
 	/** Set right-hand side of state */
 	void set_rhs(int cons, double val);
 
-	/** Set the domain of a variable. */
-	void set_domain(int var, BPDomain domain, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-	                vector<double>& minactivity, vector<double>& maxactivity);
+	/**
+	 * Set the domain of a variable. The given minactivity and maxactivity are the activity bounds of the rows over
+	 * unprocessed variables (as in BinaryProblem); this also holds for the functions below.
+	 */
+	void set_domain(int var, BPDomain domain, const BPMatrix& matrix, const vector<double>& minactivity,
+	                const vector<double>& maxactivity);
 
 
 	// Auxiliary functions
 
+	/**
+	 * Index the activity deltas of this state in the activity index of the calling thread, first removing those of
+	 * processed variables. Functions that find or update deltas require the state to be indexed; transitions and merges
+	 * index the state they modify.
+	 */
+	void bind_activity_index(const BPMatrix& matrix);
+
+	/** Minimum activity of a row over the free variables of this state */
+	double get_minactivity(int cons, const vector<double>& minactivity) const;
+
+	/** Maximum activity of a row over the free variables of this state */
+	double get_maxactivity(int cons, const vector<double>& maxactivity) const;
+
 	/** Return true if state is feasible independent of completion */
 	bool is_alwaysfeasible(int cons, RowSense sense, const vector<double>& minactivity, const vector<double>& maxactivity);
 
-	/** Update infeasibility flag of the state. Whenever min/maxactivity or rhs changes, this must be called. */
-	void update_infeasibility(int cons, double minactivity, double maxactivity, RowSense sense);
+	/**
+	 * Update infeasibility flag of the state. Whenever min/maxactivity or rhs changes, this must be called. Rows of
+	 * general class are compared with a tolerance; the others are compared exactly.
+	 */
+	void update_infeasibility(int cons, double minactivity, double maxactivity, RowSense sense, BPRowClass row_class);
 
 	/** Update rhs if it becomes redundant. Whenever min/maxactivity or rhs changes, this must be called. */
-	void update_alwaysfeasibility(int cons, double minactivity, double maxactivity, RowSense sense);
+	void update_alwaysfeasibility(int cons, double minactivity, double maxactivity, RowSense sense, BPRowClass row_class);
 
 	/** Mark a variable that has already domain {0} or {1} as processed */
 	void mark_as_processed(int var);
 
+	/**
+	 * Drop the right-hand sides of the rows before first_row, which have no unprocessed variables and so no further
+	 * effect, so that states that differ only on them are equal (see BPInstance::renumber_for_ordering)
+	 */
+	void retire_rows(int first_row);
+
 
 private:
 
 	/** Set var to val in state */
-	void set_var(Problem* prob, int var, int val, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-	             const vector<double>& init_minactivity, const vector<double>& init_maxactivity);
-	
+	void set_var(BinaryProblem* prob, int var, int val, const BPMatrix& matrix, const vector<double>& minactivity,
+	             const vector<double>& maxactivity);
+
+	/** Delta of a row, or NULL if no variable of the row is set */
+	const BPActivityDelta* find_activity_delta(int cons) const;
+
 	/**
-	 * Update minactivity and maxactivity by taking into account variables not yet visited by the solver that are set to a
-	 * smaller domain. This should only be applied to the global minactivity and maxactivity; that is, they already consider
-	 * variables visited during DD construction. Alters the given vectors.
+	 * Add (sign 1) or remove (sign -1) a set variable with the given coefficient to the activity delta of a row. Return
+	 * the delta, or NULL if it was dropped.
 	 */
-	void update_activity_from_domain(const vector<BPVar*>& vars, vector<double>& minactivity, vector<double>& maxactivity);
+	const BPActivityDelta* update_activity_delta(int cons, double coeff, int sign);
+
+	/** Remove a set variable from the activity deltas of its rows */
+	void remove_activity_deltas(int var, const BPMatrix& matrix);
+
+	/** Store the activity deltas densely (see dense_deltas) */
+	void make_deltas_dense();
+
+	/** Store the activity deltas sparsely, keeping only rows with a set variable */
+	void make_deltas_sparse();
 
 	/** Apply propagators to the domain */
-	void propagate_domain(Problem* prob, int var_fixed, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-	                      vector<double>& minactivity, vector<double>& maxactivity);
+	void propagate_domain(BinaryProblem* prob, int var_fixed, const BPMatrix& matrix, const vector<double>& minactivity,
+	                      const vector<double>& maxactivity);
 };
 
 
-inline BPState::BPState(int nvars, int ncons)
+inline BPState::BPState(int nvars, int ncons, BPRhsType rhs_type)
 {
-	rhs.resize(ncons);
+	rhs.init(ncons, rhs_type);
 	domains.init(nvars);
 	infeasible = false;
+	rhs_hash = 0;
+	dense_deltas = false;
+	ndense_deltas = 0;
+	for (int i = 0; i < ncons; ++i) {
+		rhs_hash ^= hash_key_double(i, rhs[i]);
+	}
 }
 
 
-inline BPState::BPState(const BPState& state)
-{
-	rhs = state.rhs;
-	domains = state.domains;
-	infeasible = state.infeasible;
-}
+inline BPState::BPState(const BPState& state) : rhs(state.rhs), domains(state.domains), infeasible(state.infeasible),
+	rhs_hash(state.rhs_hash), activity_deltas(state.activity_deltas), dense_deltas(state.dense_deltas),
+	ndense_deltas(state.ndense_deltas), unindexed_processed_vars(state.unindexed_processed_vars) {}
 
 
 inline void BPState::set_rhs(int cons, double val)
 {
-	rhs[cons] = val;
+	rhs_hash ^= hash_key_double(cons, rhs[cons]) ^ hash_key_double(cons, val);
+	rhs.set(cons, val);
 }
 
 
 /** Revert domain filtering changes made to right-hand sides (from {0} or {1} to {0,1}) */
-inline void revert_rhs(int var_id, const vector<BPVar*>& vars, BPState* state)
+inline void revert_rhs(int var_id, const BPMatrix& matrix, BPState* state)
 {
 	// Note minactivity/maxactivity cannot be reverted due to saturation
 	if (state->domains[var_id] == DOM_ONE) {
-		BPVar* var = vars[var_id];
-		for (int j = 0; j < (int) var->rows.size(); ++j) {
-			int cons = var->rows[j];
-			double coeff = var->row_coeffs[j];
-			state->set_rhs(cons, state->rhs[cons] + coeff);
+		for (int k = matrix.col_start[var_id]; k < matrix.col_start[var_id + 1]; ++k) {
+			int cons = matrix.col_ind[k];
+			state->set_rhs(cons, state->rhs[cons] + matrix.col_coeffs[k]);
 		}
 	}
 }
@@ -158,7 +271,7 @@ inline void BPState::merge(Problem* prob, State* state)
 	// cout << *state << endl;
 
 	assert(rhs.size() == state_bp->rhs.size());
-	assert(rhs.size() == inst_bp->rows.size());
+	assert(rhs.size() == (int) inst_bp->rows.size());
 	assert(domains.size() == state_bp->domains.size());
 	for (int i = 0; i < (int) domains.size(); ++i) {
 		// Processed variables must be the same for both nodes (i.e. they are in the same layer)
@@ -167,12 +280,20 @@ inline void BPState::merge(Problem* prob, State* state)
 	}
 
 	// Take the union of domains
+	bool indexed = false;
 	for (BPDomainsUnprocIterator it = domains.begin_unproc(); it != domains.end_unproc(); ++it) {
-		int i = it->var;
+		int i = *it;
 		if (state_bp->domains[i] != domains[i]) {
 			// Revert corresponding constraints
-			revert_rhs(i, inst_bp->vars, this);
-			revert_rhs(i, inst_bp->vars, state_bp);
+			revert_rhs(i, inst_bp->matrix, this);
+			revert_rhs(i, inst_bp->matrix, state_bp);
+			if (domains[i] != DOM_ZERO_ONE) {
+				if (!indexed) {
+					bind_activity_index(inst_bp->matrix);
+					indexed = true;
+				}
+				remove_activity_deltas(i, inst_bp->matrix);
+			}
 
 			// Relax domain to {0,1}
 			domains.set_domain(i, DOM_ZERO_ONE);
@@ -180,9 +301,11 @@ inline void BPState::merge(Problem* prob, State* state)
 	}
 
 	// Relax the right-hand side
-	for (int i = 0; i < (int) rhs.size(); ++i) {
-		if ((inst_bp->rows[i]->sense == SENSE_LE && state_bp->rhs[i] > rhs[i])
-		        || (inst_bp->rows[i]->sense == SENSE_GE && state_bp->rhs[i] < rhs[i])) {
+	const vector<RowSense>& row_sense = inst_bp->matrix.row_sense;
+	assert(rhs.get_first() == state_bp->rhs.get_first());
+	for (int i = rhs.get_first(); i < rhs.size(); ++i) {
+		if ((row_sense[i] == SENSE_LE && state_bp->rhs[i] > rhs[i])
+		        || (row_sense[i] == SENSE_GE && state_bp->rhs[i] < rhs[i])) {
 			set_rhs(i, state_bp->rhs[i]);
 		}
 	}
@@ -191,38 +314,22 @@ inline void BPState::merge(Problem* prob, State* state)
 
 inline bool BPState::equals_to(State* state)
 {
-	BPState* state_bp = dynamic_cast<BPState*>(state);
+	return equals_to(dynamic_cast<BPState*>(state));
+}
+
 
+inline bool BPState::equals_to(BPState* state_bp)
+{
 	// Domains must be the same
-	int nvars = (int) domains.size();
-	assert(nvars == (int) state_bp->domains.size());
-	for (int i = 0; i < nvars; ++i) {
-		if (domains[i] != state_bp->domains[i]) {
-			return false;
-		}
+	if (!(domains == state_bp->domains)) {
+		return false;
 	}
 
 	// Right-hand sides must be the same
-	int ncons = (int) rhs.size();
-	assert(ncons == (int) state_bp->rhs.size());
-	for (int i = 0; i < ncons; ++i) {
-		if (!DBL_EQ(rhs[i], state_bp->rhs[i])) {
-			return false;
-		}
-	}
-
-	return true;
+	return rhs.equals_to(state_bp->rhs);
 }
 
 
-struct DomainComparator {
-	bool operator()(const BPDomainNode& lhs, const BPDomainNode& rhs) const
-	{
-		return lhs.domain < rhs.domain;
-	}
-};
-
-
 inline bool BPState::less(const State& state) const
 {
 	const BPState* stateA = this;
@@ -231,15 +338,9 @@ inline bool BPState::less(const State& state) const
 	assert(!stateA->infeasible && !stateB->infeasible);
 
 	/* lexicographically compare rhs */
-	int ncons = (int) stateA->rhs.size();
-	assert(ncons == (int) stateB->rhs.size());
-	for (int i = 0; i < ncons; ++i) {
-		if (DBL_LT(stateA->rhs[i], stateB->rhs[i])) {
-			return true;
-		}
-		if (DBL_GT(stateA->rhs[i], stateB->rhs[i])) {
-			return false;
-		}
+	int rhs_cmp = stateA->rhs.compare(stateB->rhs);
+	if (rhs_cmp != 0) {
+		return rhs_cmp < 0;
 	}
 
 	/* stateA->rhs == stateB->rhs at this point*/
@@ -258,69 +359,218 @@ inline bool BPState::less(const State& state) const
 		return false;
 	}
 
-	return lexicographical_compare(stateA->domains.begin_unproc(), stateA->domains.end_unproc(),
-	                               stateB->domains.begin_unproc(), stateB->domains.end_unproc(),
-	                               DomainComparator());
+	/* lexicographically compare domains of unprocessed variables */
+	BPDomainsUnprocIterator itA = stateA->domains.begin_unproc();
+	BPDomainsUnprocIterator itB = stateB->domains.begin_unproc();
+	BPDomainsUnprocIterator endA = stateA->domains.end_unproc();
+	BPDomainsUnprocIterator endB = stateB->domains.end_unproc();
+	for (; itA != endA && itB != endB; ++itA, ++itB) {
+		BPDomain domA = stateA->domains[*itA];
+		BPDomain domB = stateB->domains[*itB];
+		if (domA != domB) {
+			return domA < domB;
+		}
+	}
+	return itA == endA && itB != endB;
 }
 
 
 /** Initialize the state of a constraint */
-inline void BPState::init_state(int cons, int cons_rhs)
+inline void BPState::init_state(int cons, double cons_rhs)
 {
 	set_rhs(cons, cons_rhs);
 }
 
 
-/** Initialize the state from a given row */
-inline void BPState::init_state_from_row(int cons, BPRow* row)
+/** Initialize the state from the rows of a matrix, which may be scaled from the rows of the instance */
+inline void BPState::init_state_from_matrix(const BPMatrix& matrix)
+{
+	for (int i = 0; i < matrix.nrows; ++i) {
+		init_state(i, matrix.row_rhs[i]);
+	}
+}
+
+
+inline void BPState::mark_as_processed(int var)
 {
-	init_state(cons, row->rhs);
+	assert(domains[var] == DOM_ZERO || domains[var] == DOM_ONE);
+	// Activity bounds of the problem account for the variable once its layer ends; see bind_activity_index
+	unindexed_processed_vars.push_back(var);
+	domains.set_domain(var, DOM_PROCESSED);
 }
 
 
-/** Initialize the state from a given set of rows */
-inline void BPState::init_state_from_rows(const vector<BPRow*>& rows)
+inline void BPState::retire_rows(int first_row)
 {
-	for (int i = 0; i < (int) rows.size(); ++i) {
-		init_state_from_row(i, rows[i]);
+	if (first_row <= rhs.get_first()) {
+		return;
 	}
+	for (int i = rhs.get_first(); i < first_row; ++i) {
+		rhs_hash ^= hash_key_double(i, rhs[i]);
+	}
+	rhs.drop_rows_before(first_row);
 }
 
 
-inline void BPState::mark_as_processed(int var)
+inline void BPState::bind_activity_index(const BPMatrix& matrix)
 {
-	assert(domains[var] == DOM_ZERO || domains[var] == DOM_ONE);
-	domains.set_domain(var, DOM_PROCESSED);
+	BPActivityIndex& index = bp_activity_index();
+	if ((int) index.stamp.size() < rhs.size()) {
+		index.stamp.resize(rhs.size(), 0);
+		index.pos.resize(rhs.size());
+	}
+	if (++index.epoch == 0) {
+		fill(index.stamp.begin(), index.stamp.end(), 0);
+		index.epoch = 1;
+	}
+	index.state = this;
+	if (!dense_deltas) {
+		for (int i = 0; i < (int) activity_deltas.size(); ++i) {
+			index.stamp[activity_deltas[i].row] = index.epoch;
+			index.pos[activity_deltas[i].row] = i;
+		}
+	}
+
+	for (int var : unindexed_processed_vars) {
+		remove_activity_deltas(var, matrix);
+	}
+	unindexed_processed_vars.clear();
+
+	if (dense_deltas && ndense_deltas < BP_DENSE_DELTAS_FRACTION / 2 * rhs.size()) {
+		make_deltas_sparse();
+	}
 }
 
 
-inline void BPState::update_activity_from_domain(const vector<BPVar*>& vars, vector<double>& minactivity, vector<double>& maxactivity)
+inline void BPState::make_deltas_dense()
 {
-	if (rhs.empty()) {
-		assert(minactivity.empty() && maxactivity.empty());
-		return; // certain states such as "set packing only" problems only rely on propagation; this is unnecessary
-	}
-
-	for (BPDomainsSetIterator it = domains.begin_set(); it != domains.end_set(); ++it) {
-		assert(it->domain != DOM_ZERO_ONE && it->domain != DOM_PROCESSED);
-		BPVar* var = vars[it->var];
-		int nrows = var->rows.size();
-		for (int i = 0; i < nrows; ++i) {
-			int cons = var->rows[i];
-			double coeff = var->row_coeffs[i];
-
-			if (coeff < 0) {
-				minactivity[cons] -= coeff;
-			} else {
-				maxactivity[cons] -= coeff;
-			}
+	assert(!dense_deltas);
+	vector<BPActivityDelta> deltas(rhs.size());
+	for (int i = 0; i < rhs.size(); ++i) {
+		BPActivityDelta delta = {i, 0, 0, 0};
+		deltas[i] = delta;
+	}
+	for (const BPActivityDelta& delta : activity_deltas) {
+		deltas[delta.row] = delta;
+	}
+	ndense_deltas = activity_deltas.size();
+	activity_deltas.swap(deltas);
+	dense_deltas = true;
+}
+
+
+inline void BPState::make_deltas_sparse()
+{
+	assert(dense_deltas);
+	BPActivityIndex& index = bp_activity_index();
+	assert(index.state == this);
+	vector<BPActivityDelta> deltas;
+	deltas.reserve(ndense_deltas);
+	for (const BPActivityDelta& delta : activity_deltas) {
+		if (delta.nvars > 0) {
+			index.stamp[delta.row] = index.epoch;
+			index.pos[delta.row] = deltas.size();
+			deltas.push_back(delta);
 		}
 	}
+	activity_deltas.swap(deltas);
+	dense_deltas = false;
+	ndense_deltas = 0;
 }
 
 
-inline void BPState::set_domain(int var, BPDomain domain, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-                                vector<double>& minactivity, vector<double>& maxactivity)
+inline const BPActivityDelta* BPState::find_activity_delta(int cons) const
+{
+	const BPActivityIndex& index = bp_activity_index();
+	assert(index.state == this);
+	if (dense_deltas) {
+		return (activity_deltas[cons].nvars > 0) ? &activity_deltas[cons] : NULL;
+	}
+	return (index.stamp[cons] == index.epoch) ? &activity_deltas[index.pos[cons]] : NULL;
+}
+
+
+inline double BPState::get_minactivity(int cons, const vector<double>& minactivity) const
+{
+	const BPActivityDelta* delta = find_activity_delta(cons);
+	return (delta == NULL) ? minactivity[cons] : minactivity[cons] + delta->min_delta;
+}
+
+
+inline double BPState::get_maxactivity(int cons, const vector<double>& maxactivity) const
+{
+	const BPActivityDelta* delta = find_activity_delta(cons);
+	return (delta == NULL) ? maxactivity[cons] : maxactivity[cons] + delta->max_delta;
+}
+
+
+inline const BPActivityDelta* BPState::update_activity_delta(int cons, double coeff, int sign)
+{
+	BPActivityIndex& index = bp_activity_index();
+	assert(index.state == this);
+	if (dense_deltas) {
+		BPActivityDelta& delta = activity_deltas[cons];
+		assert(sign > 0 || delta.nvars > 0);
+		if (delta.nvars == 0) {
+			ndense_deltas++;
+		}
+		delta.nvars += sign;
+		if (delta.nvars == 0) {
+			delta.min_delta = delta.max_delta = 0;
+			ndense_deltas--;
+			return NULL;
+		}
+		if (coeff < 0) {
+			delta.min_delta -= sign * coeff;
+		} else {
+			delta.max_delta -= sign * coeff;
+		}
+		return &delta;
+	}
+	if (index.stamp[cons] != index.epoch) {
+		assert(sign > 0);
+		if (activity_deltas.size() >= BP_DENSE_DELTAS_FRACTION * rhs.size()) {
+			make_deltas_dense();
+			return update_activity_delta(cons, coeff, sign);
+		}
+		index.stamp[cons] = index.epoch;
+		index.pos[cons] = activity_deltas.size();
+		BPActivityDelta delta = {cons, 0, 0, 0};
+		activity_deltas.push_back(delta);
+	}
+
+	// Dropping the delta when no set variable is left avoids accumulating rounding errors; the last delta takes its place
+	int pos = index.pos[cons];
+	BPActivityDelta& delta = activity_deltas[pos];
+	delta.nvars += sign;
+	if (delta.nvars == 0) {
+		delta = activity_deltas.back();
+		index.pos[delta.row] = pos;
+		activity_deltas.pop_back();
+		index.stamp[cons] = 0;
+		return NULL;
+	}
+
+	// A set variable no longer contributes its range to the activity bounds
+	if (coeff < 0) {
+		delta.min_delta -= sign * coeff;
+	} else {
+		delta.max_delta -= sign * coeff;
+	}
+	return &delta;
+}
+
+
+inline void BPState::remove_activity_deltas(int var, const BPMatrix& matrix)
+{
+	for (int k = matrix.col_start[var]; k < matrix.col_start[var + 1]; ++k) {
+		update_activity_delta(matrix.col_ind[k], matrix.col_coeffs[k], -1);
+	}
+}
+
+
+inline void BPState::set_domain(int var, BPDomain domain, const BPMatrix& matrix, const vector<double>& minactivity,
+                                const vector<double>& maxactivity)
 {
 	/* cannot switch from {0} to {1} or vice versa */
 	assert(domains[var] == DOM_ZERO_ONE || domains[var] == domain);
@@ -330,61 +580,62 @@ inline void BPState::set_domain(int var, BPDomain domain, const vector<BPVar*>&
 
 	/* update minactivity, maxactivity, and rhs, as necessary */
 	// cout << "Setting domain: var " << var << " from " << domains[var] << " to " << domain << endl;
-	int nrows = vars[var]->rows.size();
-	for (int i = 0; i < nrows; ++i) {
-		int cons = vars[var]->rows[i];
-		double coeff = vars[var]->row_coeffs[i];
+	for (int k = matrix.col_start[var]; k < matrix.col_start[var + 1]; ++k) {
+		int cons = matrix.col_ind[k];
+		double coeff = matrix.col_coeffs[k];
 
-		if (coeff < 0) {
-			minactivity[cons] -= coeff;
-		} else {
-			maxactivity[cons] -= coeff;
-		}
+		const BPActivityDelta* delta = update_activity_delta(cons, coeff, 1);
+		double cons_minactivity = minactivity[cons] + delta->min_delta;
+		double cons_maxactivity = maxactivity[cons] + delta->max_delta;
 
 		if (domain == DOM_ONE) {
 			set_rhs(cons, rhs[cons] - coeff);
 		}
 
-		update_infeasibility(cons, minactivity[cons], maxactivity[cons], rows[cons]->sense);
+		RowSense sense = matrix.row_sense[cons];
+		BPRowClass row_class = matrix.row_class[cons];
+		update_infeasibility(cons, cons_minactivity, cons_maxactivity, sense, row_class);
 		if (infeasible) {
 			// cout << "Infeasibility at row " << cons << ", setting var " << var << endl;
-			// if (rows[cons]->sense == SENSE_GE)
+			// if (matrix.row_sense[cons] == SENSE_GE)
 			//     cout << "[GE] maxactivity " << maxactivity[cons] << ", rhs " << rhs[cons] << ", coeff" << coeff << endl;
 			// else
 			//     cout << "[LE] minactivity " << minactivity[cons] << ", rhs " << rhs[cons] << ", coeff" << coeff << endl;
-			// cout << "Row: " << *(rows[cons]) << endl;
+			// cout << "Row " << cons << ", coeff " << coeff << endl;
 			return; /* stop processing when detected infeasibility */
 		}
 
-		update_alwaysfeasibility(cons, minactivity[cons], maxactivity[cons], rows[cons]->sense);
+		update_alwaysfeasibility(cons, cons_minactivity, cons_maxactivity, sense, row_class);
 	}
 
 	domains.set_domain(var, domain);
 }
 
 
-inline void BPState::update_infeasibility(int cons, double minactivity, double maxactivity, RowSense sense)
+inline void BPState::update_infeasibility(int cons, double minactivity, double maxactivity, RowSense sense,
+                                          BPRowClass row_class)
 {
 	if (sense == SENSE_GE) {
-		if (DBL_LT(maxactivity, rhs[cons])) {
+		if ((row_class == ROW_GENERAL) ? DBL_LT(maxactivity, rhs[cons]) : maxactivity < rhs[cons]) {
 			infeasible = true;
 		}
 	} else { // sense == SENSE_LE
-		if (DBL_GT(minactivity, rhs[cons])) {
+		if ((row_class == ROW_GENERAL) ? DBL_GT(minactivity, rhs[cons]) : minactivity > rhs[cons]) {
 			infeasible = true;
 		}
 	}
 }
 
 
-inline void BPState::update_alwaysfeasibility(int cons, double minactivity, double maxactivity, RowSense sense)
+inline void BPState::update_alwaysfeasibility(int cons, double minactivity, double maxactivity, RowSense sense,
+                                              BPRowClass row_class)
 {
 	if (sense == SENSE_GE) {
-		if (DBL_GE(minactivity, rhs[cons])) {
+		if ((row_class == ROW_GENERAL) ? DBL_GE(minactivity, rhs[cons]) : minactivity >= rhs[cons]) {
 			set_rhs(cons, minactivity);
 		}
 	} else { // sense == SENSE_LE
-		if (DBL_LE(maxactivity, rhs[cons])) {
+		if ((row_class == ROW_GENERAL) ? DBL_LE(maxactivity, rhs[cons]) : maxactivity <= rhs[cons]) {
 			set_rhs(cons, maxactivity);
 		}
 	}
@@ -394,11 +645,13 @@ inline void BPState::update_alwaysfeasibility(int cons, double minactivity, doub
 inline bool BPState::is_alwaysfeasible(int cons, RowSense sense, const vector<double>& minactivity, const vector<double>& maxactivity)
 {
 	if (sense == SENSE_GE) {
-		assert(rhs[cons] >= minactivity[cons]);
-		return DBL_EQ(rhs[cons], minactivity[cons]);
+		double cons_minactivity = get_minactivity(cons, minactivity);
+		assert(DBL_GE(rhs[cons], cons_minactivity));
+		return DBL_EQ(rhs[cons], cons_minactivity);
 	} else {
-		assert(rhs[cons] <= maxactivity[cons]);
-		return DBL_EQ(rhs[cons], maxactivity[cons]);
+		double cons_maxactivity = get_maxactivity(cons, maxactivity);
+		assert(DBL_LE(rhs[cons], cons_maxactivity));
+		return DBL_EQ(rhs[cons], cons_maxactivity);
 	}
 }
 
@@ -409,6 +662,11 @@ inline BPState& BPState::operator=(const BPState& rhs_state)
 	rhs = rhs_state.rhs;
 	domains = rhs_state.domains;
 	infeasible = rhs_state.infeasible;
+	rhs_hash = rhs_state.rhs_hash;
+	activity_deltas = rhs_state.activity_deltas;
+	dense_deltas = rhs_state.dense_deltas;
+	ndense_deltas = rhs_state.ndense_deltas;
+	unindexed_processed_vars = rhs_state.unindexed_processed_vars;
 	return *this;
 }
 
@@ -417,8 +675,8 @@ inline BPState& BPState::operator=(const BPState& rhs_state)
 inline void BPState::print()
 {
 	cout << "State: ";
-	for (double rhs_val : rhs) {
-		cout << rhs_val << " ";
+	for (int i = rhs.get_first(); i < rhs.size(); ++i) {
+		cout << rhs[i] << " ";
 	}
 	cout << endl;
 	cout << "Domains: ";
@@ -439,8 +697,8 @@ inline void BPState::print()
 inline std::ostream& BPState::stream_write(std::ostream& os) const
 {
 	os << "[ State [ ";
-	for (double rhs_val : rhs) {
-		os << rhs_val << " ";
+	for (int i = rhs.get_first(); i < rhs.size(); ++i) {
+		os << rhs[i] << " ";
 	}
 	os << " ] Domains [ ";
 	for (int i = 0; i < domains.nvars; ++i) {
@@ -462,19 +720,19 @@ inline std::ostream& BPState::stream_write(std::ostream& os) const
 	// os << " ]";
 
 	os << " Set vars [ ";
-	for (BPDomainsSetConstIterator it = domains.begin_set(); it != domains.end_set(); it++) {
-		os << it->var << " ";
+	for (BPDomainsSetIterator it = domains.begin_set(); it != domains.end_set(); it++) {
+		os << *it << " ";
 	}
 	os << " ]";
 	os << " [0: " << domains.nvars_set_zero << ", 1: " << domains.nvars_set_one << "]";
 	os << " Unset vars [ ";
-	for (BPDomainsUnsetConstIterator it = domains.begin_unset(); it != domains.end_unset(); it++) {
-		os << it->var << " ";
+	for (BPDomainsUnsetIterator it = domains.begin_unset(); it != domains.end_unset(); it++) {
+		os << *it << " ";
 	}
 	os << " ]";
 	// os << " Unproc vars [ ";
-	// for (BPDomainsUnprocConstIterator it = domains.begin_unproc(); it != domains.end_unproc(); it++) {
-	//     os << it->var << " ";
+	// for (BPDomainsUnprocIterator it = domains.begin_unproc(); it != domains.end_unproc(); it++) {
+	//     os << *it << " ";
 	// }
 	// os << " ]";
 	if (infeasible) {
@@ -4,10 +4,18 @@
 
 #include <algorithm>
 #include <iterator>
+#include <cassert>
 #include "bprow.hpp"
 #include "bpvar.hpp"
 
 
+BPRow::BPRow(RowSense _sense, double _rhs, const vector<double>& _coeffs, const vector<int>& _ind) : rhs(_rhs),
+	sense(_sense), coeffs(_coeffs), ind(_ind), nnonz(_ind.size()), type("linear")
+{
+	assert(nnonz == (int) coeffs.size());
+}
+
+
 #ifdef SOLVER_CPLEX
 
 BPRow::BPRow(IloRange row, RowSense _sense, const vector<BPVar*>& free_vars, bool consider_fixed)
@@ -30,6 +30,9 @@ struct BPRow {
 	int nnonz;               /**< number of coefficients/variables in the constraint */
 	const char* type;        /**< type of constraint */
 
+	/** Constructor from the coefficients and variable indices of the constraint */
+	BPRow(RowSense _sense, double _rhs, const vector<double>& _coeffs, const vector<int>& _ind);
+
 #ifdef SOLVER_CPLEX
 	BPRow(IloRange row, RowSense _sense, const vector<BPVar*>& free_vars, bool consider_fixed=true);
 #endif
@@ -27,6 +27,9 @@ struct BPVar {
 
 	int solver_index;          /**< solver's index of var (used only at initialization of rows/vars) */
 
+	/** Constructor (does not set rows; use init_rows) */
+	BPVar(double _obj, int _index) : obj(_obj), index(_index), solver_index(-1) {}
+
 #ifdef SOLVER_CPLEX
 	/** Constructor from CPLEX var (does not set rows; use init_rows) */
 	BPVar(IloNumVar& var, IloNum var_obj, int _index);
@@ -5,58 +5,107 @@
 #include "prop_linearcons.hpp"
 
 
-void BPPropLinearcons::propagate(BPState* state, int v, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-                                 vector<double>& minactivity, vector<double>& maxactivity, bool& infeasible, unordered_set<int>& fixed_vars_next)
+/** Comparisons of an activity with a right-hand side, exact for unit and integral rows and with tolerance otherwise */
+static inline bool row_lt(double activity, double rhs, bool exact)
 {
-	unordered_set<int> vars_to_check;
+	return exact ? activity < rhs : DBL_LT(activity, rhs);
+}
 
-	// Gather all unfixed variables sharing a constraint with v in order to avoid revisiting variables
-	add_neighbors(v, vars_to_check, state, vars, rows, minactivity, maxactivity);
+static inline bool row_gt(double activity, double rhs, bool exact)
+{
+	return exact ? activity > rhs : DBL_GT(activity, rhs);
+}
 
-	// Check if any neighbor of v can have their domain fixed
-	for (int u : vars_to_check) {
-		if (state->domains[u] != DOM_ZERO_ONE) {
-			continue;    // this can happen if a domain was changed during this propagation step
-		}
 
-		BPVar* var = vars[u];
-		int nrows_var = var->rows.size();
+void BPPropLinearcons::propagate_row(BPState* state, int row_idx, const BPMatrix& matrix, const vector<double>& minactivity,
+                                     const vector<double>& maxactivity, BPPropWorklist& worklist, bool& infeasible)
+{
+	switch (matrix.row_class[row_idx]) {
+	case ROW_UNIT:
+		propagate_unit_row(state, row_idx, matrix, minactivity, maxactivity, worklist, infeasible);
+		break;
+	case ROW_INTEGRAL:
+		propagate_linear_row(state, row_idx, matrix, minactivity, maxactivity, worklist, infeasible, true);
+		break;
+	case ROW_GENERAL:
+		propagate_linear_row(state, row_idx, matrix, minactivity, maxactivity, worklist, infeasible, false);
+		break;
+	}
+}
 
-		for (int i = 0; i < nrows_var && !state->infeasible; ++i) {
-			int row_idx = var->rows[i];
-			double coeff = var->row_coeffs[i];
 
-			// We skip the check if the row is always feasible because this step is relatively cheap
-			// Try to reduce domain
-			BPDomain domain = get_smallest_domain(state, row_idx, coeff, u, rows[row_idx]->sense, minactivity[row_idx], maxactivity[row_idx]);
+void BPPropLinearcons::propagate_unit_row(BPState* state, int row_idx, const BPMatrix& matrix,
+                                          const vector<double>& minactivity, const vector<double>& maxactivity,
+                                          BPPropWorklist& worklist, bool& infeasible)
+{
+	// The minimum activity over free variables is zero and the maximum is their number, so fixing one variable keeps the
+	// others fixable: either all free variables are fixed or none is
+	BPDomain domain;
+	if (matrix.row_sense[row_idx] == SENSE_GE) {
+		if (state->get_maxactivity(row_idx, maxactivity) > state->rhs[row_idx]) {
+			return;
+		}
+		domain = DOM_ONE;
+	} else { // sense == SENSE_LE
+		if (state->rhs[row_idx] >= 1) {
+			return;
+		}
+		domain = DOM_ZERO;
+	}
 
-			if (domain != DOM_ZERO_ONE) {
-				// cout << "Setting var " << u << " to " << domain << " due to row " << row_idx << endl;
-				// cout << "Minact " << minactivity[row_idx] << ", Maxact " << maxactivity[row_idx] << endl;
-				// cout << "Row " << row_idx << ": " << *(rows[row_idx]) << endl;
-				state->set_domain(u, domain, vars, rows, minactivity, maxactivity);
-				fixed_vars_next.insert(u);
-				break;
-			}
+	for (int k = matrix.row_start[row_idx]; k < matrix.row_start[row_idx + 1]; ++k) {
+		int u = matrix.row_ind[k];
+		if (state->domains[u] != DOM_ZERO_ONE) {
+			continue;
+		}
+		state->set_domain(u, domain, matrix, minactivity, maxactivity);
+		worklist.push_var(u);
+		if (state->infeasible) {
+			infeasible = true;
+			return;
 		}
 	}
 }
 
 
-void BPPropLinearcons::add_neighbors(int init_var, unordered_set<int>& vars_set, BPState* state, const vector<BPVar*>& vars,
-                                     const vector<BPRow*>& rows, vector<double>& minactivity, vector<double>& maxactivity)
+void BPPropLinearcons::propagate_linear_row(BPState* state, int row_idx, const BPMatrix& matrix,
+                                            const vector<double>& minactivity, const vector<double>& maxactivity,
+                                            BPPropWorklist& worklist, bool& infeasible, bool exact)
 {
-	BPVar* var = vars[init_var];
-	int nrows_var = var->rows.size();
-
-	// Add all variables participating in a constraint init_var is in, except for constraints that are always feasible
-	for (int i = 0; i < nrows_var; ++i) {
-		int row_idx = var->rows[i];
-		if (!state->is_alwaysfeasible(row_idx, rows[row_idx]->sense, minactivity, maxactivity)) {
-			for (int v : rows[row_idx]->ind) {
-				if (v != init_var && state->domains[v] == DOM_ZERO_ONE) {
-					vars_set.insert(v);
-				}
+	RowSense sense = matrix.row_sense[row_idx];
+
+	// A variable can only be fixed if its coefficient exceeds the slack of the row, so rows whose slack covers the
+	// largest coefficient are skipped without a scan; this includes rows that are always feasible
+	double max_coeff = matrix.row_max_coeff[row_idx];
+	if (sense == SENSE_GE) {
+		if (!row_lt(state->get_maxactivity(row_idx, maxactivity) - max_coeff, state->rhs[row_idx], exact)) {
+			return;
+		}
+	} else { // sense == SENSE_LE
+		if (!row_gt(state->get_minactivity(row_idx, minactivity) + max_coeff, state->rhs[row_idx], exact)) {
+			return;
+		}
+	}
+
+	// Check if any free variable of the row can have its domain fixed; fixing one changes the activity of the row, so
+	// the following variables are checked against the updated activity
+	for (int k = matrix.row_start[row_idx]; k < matrix.row_start[row_idx + 1]; ++k) {
+		int u = matrix.row_ind[k];
+		if (state->domains[u] != DOM_ZERO_ONE) {
+			continue;
+		}
+
+		BPDomain domain = get_smallest_domain(state, row_idx, matrix.row_coeffs[k], u, sense,
+		                                       state->get_minactivity(row_idx, minactivity),
+		                                       state->get_maxactivity(row_idx, maxactivity), exact);
+
+		if (domain != DOM_ZERO_ONE) {
+			// cout << "Setting var " << u << " to " << domain << " due to row " << row_idx << endl;
+			state->set_domain(u, domain, matrix, minactivity, maxactivity);
+			worklist.push_var(u);
+			if (state->infeasible) {
+				infeasible = true;
+				return;
 			}
 		}
 	}
@@ -64,27 +113,27 @@ void BPPropLinearcons::add_neighbors(int init_var, unordered_set<int>& vars_set,
 
 
 BPDomain BPPropLinearcons::get_smallest_domain(BPState* state, int cons, double coeff, int var, RowSense sense,
-        double minactivity, double maxactivity)
+        double minactivity, double maxactivity, bool exact)
 {
 	assert(state->domains[var] == DOM_ZERO_ONE);
 
 	if (sense == SENSE_GE) {
 		if (coeff < 0) {
-			if (DBL_LT(maxactivity + coeff, state->rhs[cons])) {
+			if (row_lt(maxactivity + coeff, state->rhs[cons], exact)) {
 				return DOM_ZERO;
 			}
 		} else {
-			if (DBL_LT(maxactivity - coeff, state->rhs[cons])) {
+			if (row_lt(maxactivity - coeff, state->rhs[cons], exact)) {
 				return DOM_ONE;
 			}
 		}
 	} else { // sense == SENSE_LE
 		if (coeff < 0) {
-			if (DBL_GT(minactivity - coeff, state->rhs[cons])) {
+			if (row_gt(minactivity - coeff, state->rhs[cons], exact)) {
 				return DOM_ONE;
 			}
 		} else {
-			if (DBL_GT(minactivity + coeff, state->rhs[cons])) {
+			if (row_gt(minactivity + coeff, state->rhs[cons], exact)) {
 				return DOM_ZERO;
 			}
 		}
@@ -5,7 +5,6 @@
 #ifndef PROP_LINEARCONS_HPP_
 #define PROP_LINEARCONS_HPP_
 
-#include <unordered_set>
 #include "bp_prop.hpp"
 #include "bp_domains.hpp"
 #include "bprow.hpp"
@@ -16,7 +15,7 @@ using namespace std;
 
 /**
  * Domain propagator for linear constraints. Applies to the constraints in the problem, as we need
- * minactivity/maxactivity and RHSs.
+ * minactivity/maxactivity and RHSs. Each row is propagated by the kernel of its class (see BPRowClass).
  */
 class BPPropLinearcons : public BPProp
 {
@@ -25,16 +24,22 @@ class BPPropLinearcons : public BPProp
 public:
 	BPPropLinearcons(vector<BPRow*>& _rows_prop) : rows_prop(_rows_prop) {}
 
-	void propagate(BPState* state, int v, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-	               vector<double>& minactivity, vector<double>& maxactivity, bool& infeasible, unordered_set<int>& fixed_vars_next);
+	void propagate_row(BPState* state, int row, const BPMatrix& matrix, const vector<double>& minactivity,
+	                   const vector<double>& maxactivity, BPPropWorklist& worklist, bool& infeasible);
 
 private:
-	/** Add to vars_set all free variables participating in the constraints v is in. */
-	void add_neighbors(int init_var, unordered_set<int>& vars_set, BPState* state, const vector<BPVar*>& vars,
-	                   const vector<BPRow*>& rows, vector<double>& minactivity, vector<double>& maxactivity);
+
+	/** Counting kernel for unit rows (see BPRowClass) */
+	void propagate_unit_row(BPState* state, int row, const BPMatrix& matrix, const vector<double>& minactivity,
+	                        const vector<double>& maxactivity, BPPropWorklist& worklist, bool& infeasible);
+
+	/** Kernel for integral and general rows; comparisons are exact for integral rows */
+	void propagate_linear_row(BPState* state, int row, const BPMatrix& matrix, const vector<double>& minactivity,
+	                          const vector<double>& maxactivity, BPPropWorklist& worklist, bool& infeasible, bool exact);
 
 	/** Return the smallest domain for the given variable w.r.t. a single constraint, assuming domain is not yet set */
-	BPDomain get_smallest_domain(BPState* state, int cons, double coeff, int var, RowSense sense, double minactivity, double maxactivity);
+	BPDomain get_smallest_domain(BPState* state, int cons, double coeff, int var, RowSense sense, double minactivity,
+	                             double maxactivity, bool exact);
 };
 
 
@@ -5,29 +5,34 @@
 #include "prop_multipass.hpp"
 
 
-void BPPropMultipass::propagate(BPState* state, int v, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-                                vector<double>& minactivity, vector<double>& maxactivity, bool& infeasible)
+void BPPropMultipass::propagate(BPState* state, int v, const BPMatrix& matrix, const vector<double>& minactivity,
+                                const vector<double>& maxactivity, bool& infeasible)
 {
 	assert(state->domains[v] == DOM_ZERO || state->domains[v] == DOM_ONE);
 
-	unordered_set<int> fixed_vars;
-	unordered_set<int> fixed_vars_next;
+	int nprops = propagators.size();
+	long nfixings[MAX_PROPAGATORS] = {0};
 
-	fixed_vars.insert(v);
+	BPPropWorklist& worklist = bp_prop_worklist();
+	worklist.start(matrix.nrows);
+	worklist.push_var(v);
 
-	// Run propagator on each fixed variable, collecting the set for the next pass
-	for (int pass = 0; pass < npasses && !fixed_vars.empty(); ++pass) {
-		for (int cur_var : fixed_vars) {
-			assert(state->domains[cur_var] == DOM_ZERO || state->domains[cur_var] == DOM_ONE);
-			for (BPProp* propagator : propagators) {
-				propagator->propagate(state, cur_var, vars, rows, minactivity, maxactivity, infeasible, fixed_vars_next);
-				if (infeasible) {
-					return;
-				}
-			}
+	// Run propagators on each row whose activity changed, which queues the rows of the variables they fix
+	long nrows_scanned = 0;
+	int row;
+	while ((row_budget < 0 || nrows_scanned < row_budget) && worklist.pop_row(matrix, row)) {
+		nrows_scanned++;
+		for (int i = 0; i < nprops && !infeasible; ++i) {
+			int nvars_pushed = worklist.get_nvars_pushed();
+			propagators[i]->propagate_row(state, row, matrix, minactivity, maxactivity, worklist, infeasible);
+			nfixings[i] += worklist.get_nvars_pushed() - nvars_pushed;
 		}
+		if (infeasible) {
+			break;
+		}
+	}
 
-		fixed_vars = fixed_vars_next;
-		fixed_vars_next.clear();
+	for (int i = 0; i < nprops; ++i) {
+		propagators[i]->add_counts(nrows_scanned, nfixings[i]);
 	}
 }
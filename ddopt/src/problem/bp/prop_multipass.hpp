@@ -5,42 +5,48 @@
 #ifndef PROP_MULTIPASS_HPP_
 #define PROP_MULTIPASS_HPP_
 
-#include <unordered_set>
 #include "bp_prop.hpp"
-#include "bprow.hpp"
-#include "bpvar.hpp"
 
 using namespace std;
 
+#define MAX_PROPAGATORS 8   /* propagators wrapped together; bounds the counts kept during a propagation */
+
 
 /**
- * Domain propagator wrapper that runs multiple passes on a list of propagators.
- * Internal propagator has the responsibility of tracking which variables need to be repropagated on.
+ * Domain propagator wrapper that runs a list of propagators on the rows of a worklist. Starting from the rows of the
+ * fixed variable, rows of the variables fixed by propagation are scanned in turn until a fixpoint or the row budget is
+ * reached.
  */
 class BPPropMultipass
 {
-	vector<BPProp*> propagators;           /**< list of propagators to run a number of passes on */
-	int             npasses;               /**< number of propagation passes to run */
+	vector<BPProp*> propagators;           /**< list of propagators to run on each row */
+	int             row_budget;            /**< maximum number of rows scanned per propagation (-1 means until fixpoint) */
 
 public:
 
-	/** Default: single pass */
-	BPPropMultipass(BPProp* _propagator) : BPPropMultipass(_propagator, 1) {}
-	BPPropMultipass(vector<BPProp*> _propagators) : BPPropMultipass(_propagators, 1) {}
+	/** Default: propagate until fixpoint */
+	BPPropMultipass(BPProp* _propagator) : BPPropMultipass(_propagator, -1) {}
+	BPPropMultipass(vector<BPProp*> _propagators) : BPPropMultipass(_propagators, -1) {}
 
-	BPPropMultipass(BPProp* _propagator, int _npasses) : npasses(_npasses)
-	{
-		propagators.push_back(_propagator);
-	}
+	BPPropMultipass(BPProp* _propagator, int _row_budget) : BPPropMultipass(vector<BPProp*>(1, _propagator), _row_budget) {}
 
-	BPPropMultipass(vector<BPProp*> _propagators, int _npasses) : npasses(_npasses)
+	BPPropMultipass(vector<BPProp*> _propagators, int _row_budget) : row_budget(_row_budget)
 	{
 		propagators = _propagators;
+		if ((int) propagators.size() > MAX_PROPAGATORS) {
+			cout << "Error: Too many propagators" << endl;
+			exit(1);
+		}
 	}
 
-	/** Propagate by running a number of passes on propagator, assuming it tracks newly updated variables */
-	void propagate(BPState* state, int v, const vector<BPVar*>& vars, const vector<BPRow*>& rows,
-	               vector<double>& minactivity, vector<double>& maxactivity, bool& infeasible);
+	/** Propagate the fixing of variable v */
+	void propagate(BPState* state, int v, const BPMatrix& matrix, const vector<double>& minactivity,
+	               const vector<double>& maxactivity, bool& infeasible);
+
+	const vector<BPProp*>& get_propagators() const
+	{
+		return propagators;
+	}
 };
 
 
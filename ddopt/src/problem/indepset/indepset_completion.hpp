@@ -7,6 +7,7 @@
 
 #include "../../core/completion.hpp"
 #include "indepset_state.hpp"
+#include "indepset_instance.hpp"
 
 
 /** Use the size of state; that is, the number of vertices that can still be assigned to 1. Only for weights (1,...,1). */
@@ -14,9 +15,25 @@ class StateSizeCompletionBound : public CompletionBound
 {
 	double dual_bound(Instance* inst, Node* node, Node* parent)
 	{
-		IndepSetState* state = dynamic_cast<IndepSetState*>(node->state);
+		IndepSetState* state = static_cast<IndepSetState*>(node->state);
 		return state->get_size();
 	}
 };
 
+
+/** Use the total positive weight of the vertices in the state; that is, of the vertices that can still be assigned to 1. */
+class StateWeightCompletionBound : public CompletionBound
+{
+	double dual_bound(Instance* inst, Node* node, Node* parent)
+	{
+		IndepSetState* state = static_cast<IndepSetState*>(node->state);
+		const int* position_vertex = static_cast<IndepSetInstance*>(inst)->position_vertex;
+		double bound = 0;
+		for (int p = state->intset.get_first(); p != state->intset.get_end(); p = state->intset.get_next(p)) {
+			bound += MAX(0, inst->weights[position_vertex[p]]);
+		}
+		return bound;
+	}
+};
+
 #endif /* INDEPSET_COMPLETION_HPP_ */
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "indepset_instance.hpp"
+#include "../../util/hash.hpp"
 
 using namespace std;
 
@@ -32,19 +33,75 @@ void IndepSetInstance::create_from_graph(Graph* orig_graph, const vector<double>
 		weights[i] = obj[i];
 	}
 
+	// create hash keys for states
+	vertex_hash_keys = new size_t[graph->n_vertices];
+	for (int v = 0; v < graph->n_vertices; v++) {
+		vertex_hash_keys[v] = hash_key(v);
+	}
+
+	// positions are the vertex indices until renumbered
+	adj_mask_compl = NULL;
+	vertex_position = NULL;
+	position_vertex = NULL;
+	vector<int> vertex_in_position(graph->n_vertices);
+	for (int v = 0; v < graph->n_vertices; v++) {
+		vertex_in_position[v] = v;
+	}
+	set_positions(vertex_in_position);
+	layer_positions = false;
+}
+
+
+/**
+ * Renumber positions so that the vertex at each layer of the given static ordering has the layer as position
+ */
+void IndepSetInstance::renumber_for_ordering(Ordering* ordering)
+{
+	assert(ordering->is_static());
+	vector<int> vertex_in_position(graph->n_vertices);
+	vector<bool> taken(graph->n_vertices, false);
+	for (int layer = 0; layer < graph->n_vertices; layer++) {
+		int v = ordering->select_next_var(layer);
+		if (v < 0 || v >= graph->n_vertices || taken[v]) {
+			cout << "Error: ordering is not a permutation of the vertices" << endl;
+			exit(1);
+		}
+		vertex_in_position[layer] = v;
+		taken[v] = true;
+	}
+	set_positions(vertex_in_position);
+	layer_positions = true;
+}
+
+
+/**
+ * Set positions and create the adjacency masks over them
+ */
+void IndepSetInstance::set_positions(const vector<int>& vertex_in_position)
+{
+	delete[] vertex_position;
+	delete[] position_vertex;
+	vertex_position = new int[graph->n_vertices];
+	position_vertex = new int[graph->n_vertices];
+	for (int p = 0; p < graph->n_vertices; p++) {
+		position_vertex[p] = vertex_in_position[p];
+		vertex_position[vertex_in_position[p]] = p;
+	}
+
 	// create complement mask of adjacencies
+	delete[] adj_mask_compl;
 	adj_mask_compl = new IntSet[graph->n_vertices];
 	for (int v = 0; v < graph->n_vertices; v++) {
 
 		adj_mask_compl[v].resize(0, graph->n_vertices-1, true);
 		for (int w = 0; w < graph->n_vertices; w++) {
 			if (graph->is_adj(v,w)) {
-				adj_mask_compl[v].remove(w);
+				adj_mask_compl[v].remove(vertex_position[w]);
 			}
 		}
 
 		// a vertex is adjacent to itself
-		adj_mask_compl[v].remove(v);
+		adj_mask_compl[v].remove(vertex_position[v]);
 
 	}
 }
@@ -13,6 +13,7 @@
 #include "../../util/intset.hpp"
 
 #include "../instance.hpp"
+#include "../../core/order.hpp"
 
 using namespace std;
 
@@ -24,13 +25,26 @@ class IndepSetInstance : public Instance
 {
 public:
 	Graph*              graph;             /**< independent set graph */
-	IntSet*             adj_mask_compl;	   /**< complement mask of adjacencies */
+	IntSet*             adj_mask_compl;	   /**< complement mask of adjacencies of each vertex, over positions */
+	size_t*             vertex_hash_keys;  /**< hash key of each position; a state hash is the XOR of the keys of its positions */
+
+	/**
+	 * States store vertices by position rather than by index. Positions are the vertex indices unless the instance is
+	 * renumbered for a static ordering, in which case the vertex at layer k has position k.
+	 */
+	int*                vertex_position;   /**< position of each vertex */
+	int*                position_vertex;   /**< vertex at each position */
+	bool                layer_positions;   /**< true if renumbered for a static ordering: positions below the current
+	                                            layer are never in a state, so states may drop them */
 
 
 	~IndepSetInstance()
 	{
 		delete graph;
 		delete[] adj_mask_compl;
+		delete[] vertex_hash_keys;
+		delete[] vertex_position;
+		delete[] position_vertex;
 		delete[] weights;
 	}
 
@@ -42,6 +56,14 @@ public:
 
 	/** Read DIMACS independent set instance with optional weights file */
 	void read_DIMACS(const char* filename, const char* weights_file = NULL);
+
+	/** Renumber positions so that the vertex at each layer of the given static ordering has the layer as position */
+	void renumber_for_ordering(Ordering* ordering);
+
+private:
+
+	/** Set positions and create the adjacency masks over them */
+	void set_positions(const vector<int>& vertex_in_position);
 };
 
 
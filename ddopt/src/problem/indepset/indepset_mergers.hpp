@@ -19,8 +19,8 @@ Merger* get_merger_by_id_indepset(int id, int width);
 struct CompareNodesStateSizeAscending {
 	bool operator()(Node* nodeA, Node* nodeB) const
 	{
-		IndepSetState* stateA = dynamic_cast<IndepSetState*>(nodeA->state);
-		IndepSetState* stateB = dynamic_cast<IndepSetState*>(nodeB->state);
+		IndepSetState* stateA = static_cast<IndepSetState*>(nodeA->state);
+		IndepSetState* stateB = static_cast<IndepSetState*>(nodeB->state);
 		if (stateA->get_size() != stateB->get_size()) {
 			return stateA->get_size() < stateB->get_size();
 		}
@@ -37,8 +37,8 @@ struct CompareNodesStateSizeAscending {
 struct CompareNodesStateSizeDescending {
 	bool operator()(Node* nodeA, Node* nodeB) const
 	{
-		IndepSetState* stateA = dynamic_cast<IndepSetState*>(nodeA->state);
-		IndepSetState* stateB = dynamic_cast<IndepSetState*>(nodeB->state);
+		IndepSetState* stateA = static_cast<IndepSetState*>(nodeA->state);
+		IndepSetState* stateB = static_cast<IndepSetState*>(nodeB->state);
 		if (stateA->get_size() != stateB->get_size()) {
 			return stateA->get_size() > stateB->get_size();
 		}
@@ -58,6 +58,11 @@ struct MinSizeMerger : Merger {
 	{
 		merge_nodes_past_width_iteratively(prob, nodes_layer, width, CompareNodesStateSizeDescending());
 	}
+
+	void restrict_layer(Problem* prob, int layer, vector<Node*>& nodes_layer)
+	{
+		drop_nodes_past_width(nodes_layer, width, CompareNodesStateSizeDescending());
+	}
 };
 
 
@@ -69,6 +74,11 @@ struct MaxSizeMerger : Merger {
 	{
 		merge_nodes_past_width_iteratively(prob, nodes_layer, width, CompareNodesStateSizeAscending());
 	}
+
+	void restrict_layer(Problem* prob, int layer, vector<Node*>& nodes_layer)
+	{
+		drop_nodes_past_width(nodes_layer, width, CompareNodesStateSizeAscending());
+	}
 };
 
 
@@ -76,13 +86,22 @@ struct MaxSizeMerger : Merger {
 struct MinNewSolsBound {
 	double operator()(Node* nodeA, Node* nodeB) const
 	{
-		IndepSetState* stateA = dynamic_cast<IndepSetState*>(nodeA->state);
-		IndepSetState* stateB = dynamic_cast<IndepSetState*>(nodeB->state);
+		IndepSetState* stateA = static_cast<IndepSetState*>(nodeA->state);
+		IndepSetState* stateB = static_cast<IndepSetState*>(nodeB->state);
 		return MAX(nodeA->longest_path + stateB->get_size(),
 		           nodeB->longest_path + stateA->get_size());
 	}
 };
 
+/** Lower bound on MinNewSolsBound of a pair, split between its nodes: the maximum is at least the average of both sums */
+struct MinNewSolsBoundKey {
+	double operator()(Node* node) const
+	{
+		IndepSetState* state = static_cast<IndepSetState*>(node->state);
+		return (node->longest_path + state->get_size()) / 2.0;
+	}
+};
+
 /**
  * Minimum dual bound of merged node
  */
@@ -92,7 +111,7 @@ struct MinNewSolsBoundMerger : Merger {
 
 	void merge_layer(Problem* prob, int layer, vector<Node*>& nodes_layer)
 	{
-		merge_nodes_pairs_value(prob, nodes_layer, width, MinNewSolsBound(), false);
+		merge_nodes_pairs_value(prob, nodes_layer, width, MinNewSolsBound(), false, MinNewSolsBoundKey());
 	}
 };
 
@@ -48,28 +48,29 @@ void MinInState::cb_initialize()
 {
 	// initialize in-state counter with initial state
 	memset(in_state_counter, 0, sizeof(int)*inst->graph->n_vertices);
+	selected.assign(inst->graph->n_vertices, false);
 }
 
 void MinInState::cb_state_created(State* state)
 {
-	IndepSetState* state_is = dynamic_cast<IndepSetState*>(state);
+	IndepSetState* state_is = static_cast<IndepSetState*>(state);
 
 	// increment active state counter
 	int v = state_is->intset.get_first();
 	while (v != state_is->intset.get_end()) {
-		in_state_counter[v]++;
+		in_state_counter[inst->position_vertex[v]]++;
 		v = state_is->intset.get_next(v);
 	}
 }
 
 void MinInState::cb_state_removed(State* state)
 {
-	IndepSetState* state_is = dynamic_cast<IndepSetState*>(state);
+	IndepSetState* state_is = static_cast<IndepSetState*>(state);
 
 	// decrement active state counter
 	int v = state_is->intset.get_first();
 	while (v != state_is->intset.get_end()) {
-		in_state_counter[v]--;
+		in_state_counter[inst->position_vertex[v]]--;
 		v = state_is->intset.get_next(v);
 	}
 }
@@ -77,19 +78,36 @@ void MinInState::cb_state_removed(State* state)
 // min in state heuristic
 int MinInState::select_next_var(int layer)
 {
+	int v;
 	if (prob == 1) {
-		return select_vertex_with_min_in_state(layer);
+		v = select_vertex_with_min_in_state(layer);
+	} else {
+		// check if we will randomize our selection or not
+		double probabilities[] = {prob, 1.0 - prob};
+		boost::random::discrete_distribution<> dist(probabilities);
+
+		if (dist(gen) == 0) {
+			v = select_vertex_with_min_in_state(layer);
+		} else {
+			v = select_vertex_randomly(layer);
+		}
 	}
 
-	// check if we will randomize our selection or not
-	double probabilities[] = {prob, 1.0 - prob};
-	boost::random::discrete_distribution<> dist(probabilities);
+	selected[v] = true;
+	return v;
+}
 
-	if (dist(gen) == 0) {
-		return select_vertex_with_min_in_state(layer);
+// vertex for a layer after all states became empty, which happens in a DD starting at a state that is not the initial
+// one (e.g. a branch-and-bound subproblem); such vertices are skipped with long arcs
+int MinInState::select_vertex_in_no_state(int layer)
+{
+	for (int v = 0; v < inst->graph->n_vertices; v++) {
+		if (!selected[v]) {
+			return v;
+		}
 	}
-
-	return select_vertex_randomly(layer);
+	assert(false);
+	return -1;
 }
 
 int MinInState::select_vertex_with_min_in_state(int layer)
@@ -103,7 +121,9 @@ int MinInState::select_vertex_with_min_in_state(int layer)
 		}
 	}
 
-	assert(selected_vertex >= 0);
+	if (selected_vertex < 0) {
+		return select_vertex_in_no_state(layer);
+	}
 
 	return selected_vertex;
 }
@@ -118,7 +138,9 @@ int MinInState::select_vertex_randomly(int layer)
 		}
 	}
 
-	assert(selectable_vertices.size() > 0);
+	if (selectable_vertices.empty()) {
+		return select_vertex_in_no_state(layer);
+	}
 	boost::random::uniform_int_distribution<> vertex_selector(0, (selectable_vertices.size()-1));
 
 	return selectable_vertices[ vertex_selector(gen) ];
@@ -25,6 +25,7 @@ struct MinInState : Ordering {
 	IndepSetInstance* inst;
 	boost::random::mt19937 gen;
 	int* in_state_counter;          /**< number of states containing each variable */
+	vector<bool> selected;          /**< vertices selected in previous layers */
 	double prob;			        /**< probability min in state is applied (otherwise random) */
 
 	MinInState(IndepSetInstance* _inst, double _prob = 1) : inst(_inst), prob(_prob)
@@ -47,6 +48,7 @@ struct MinInState : Ordering {
 	int select_next_var(int layer);
 	int select_vertex_with_min_in_state(int layer);
 	int select_vertex_randomly(int layer);
+	int select_vertex_in_no_state(int layer);
 
 	void cb_initialize();
 	void cb_state_created(State* state);
@@ -72,6 +74,11 @@ struct MaximalPathDecomp : Ordering {
 		return v_in_layer[layer];
 	}
 
+	bool is_static()
+	{
+		return true;
+	}
+
 private:
 	void construct_ordering();
 };
@@ -95,6 +102,11 @@ struct MinDegreeOrdering : Ordering {
 		return v_in_layer[layer];
 	}
 
+	bool is_static()
+	{
+		return true;
+	}
+
 private:
 	void construct_ordering();
 };
@@ -128,6 +140,11 @@ struct CutVertexDecomposition : Ordering {
 		return v_in_layer[layer];
 	}
 
+	bool is_static()
+	{
+		return true;
+	}
+
 private:
 	void        restrict_graph();
 	void        regenerate_graph();
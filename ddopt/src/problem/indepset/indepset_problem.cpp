@@ -8,7 +8,7 @@
 
 bool IndepSetProblem::cb_skip_var_for_long_arc(int var, State* state)
 {
-	IndepSetState* state_is = dynamic_cast<IndepSetState*>(state);
+	IndepSetState* state_is = static_cast<IndepSetState*>(state);
 
-	return !state_is->intset.contains(var);
+	return !state_is->intset.contains(instance->vertex_position[var]);
 }
@@ -14,6 +14,10 @@
 class IndepSetProblem : public Problem
 {
 public:
+	typedef IndepSetState StateType;
+
+	static const bool probe_transitions = true;
+
 
 	IndepSetInstance* instance;        /**< casted instance for convenience */
 
@@ -31,7 +35,7 @@ public:
 	{
 		IntSet intset;
 		intset.resize(0, instance->graph->n_vertices-1, true);
-		return new IndepSetState(intset);
+		return new IndepSetState(intset, instance->vertex_hash_keys);
 	}
 
 	bool cb_skip_var_for_long_arc(int var, State* state);
@@ -43,4 +47,51 @@ public:
 };
 
 
+inline IndepSetState* IndepSetState::transition(IndepSetProblem* prob, int var, int val)
+{
+	if (val == 1 && !intset.contains(prob->instance->vertex_position[var])) {
+		return NULL;
+	}
+
+	IndepSetState* new_state = new IndepSetState();
+	transition_into(prob, var, val, new_state);
+	return new_state;
+}
+
+
+inline bool IndepSetState::transition_into(IndepSetProblem* prob, int var, int val, IndepSetState* successor) const
+{
+	assert(val == 0 || val == 1);
+
+	IndepSetInstance* insti = prob->instance;
+	int pos = insti->vertex_position[var];
+	bool in_state = intset.contains(pos);
+
+	if (val == 1 && !in_state) {
+		return false;
+	}
+
+	// If positions follow the layers, all positions up to the vertex are out of the state from now on
+	successor->intset.assign(intset, insti->layer_positions ? pos + 1 : 0);
+	successor->hash_val = hash_val;
+
+	// Remove vertex itself
+	if (in_state) {
+		successor->intset.remove(pos);
+		successor->hash_val ^= insti->vertex_hash_keys[pos];
+	}
+
+	// Remove neighbors of vertex if added to graph
+	if (val == 1) {
+		const size_t* vertex_hash_keys = insti->vertex_hash_keys;
+		size_t& hash_val = successor->hash_val;
+		successor->intset.intersect_with(insti->adj_mask_compl[var], [&](int w) {
+			hash_val ^= vertex_hash_keys[w];
+		});
+	}
+
+	return true;
+}
+
+
 #endif /* INDEPSET_PROBLEM_HPP_ */
@@ -4,31 +4,27 @@
 
 #include "indepset_state.hpp"
 #include "indepset_instance.hpp"
+#include "indepset_problem.hpp"
 
 State* IndepSetState::transition(Problem* prob, int var, int val)
 {
-	assert(val == 0 || val == 1);
-
-	if (val == 1 && !intset.contains(var)) {
-		return NULL;
-	}
-
-	IndepSetInstance* insti = dynamic_cast<IndepSetInstance*>(prob->inst);
-	if (insti == NULL) {
-		cout << "Error: Using incompatible State and Instance" << endl;
+	IndepSetProblem* prob_is = dynamic_cast<IndepSetProblem*>(prob);
+	if (prob_is == NULL) {
+		cout << "Error: Using incompatible State and Problem" << endl;
 		exit(1);
 	}
+	return transition(prob_is, var, val);
+}
 
-	IndepSetState* new_state;
-	new_state = new IndepSetState(intset);
-
-	// Remove vertex itself
-	new_state->intset.remove(var);
-
-	// Remove neighbors of vertex if added to graph
-	if (val == 1) {
-		new_state->intset.set &= insti->adj_mask_compl[var].set;
-	}
 
-	return new_state;
+void IndepSetState::merge(Problem* prob, State* rhs)
+{
+	IndepSetState* rhsi = dynamic_cast<IndepSetState*>(rhs);
+	IndepSetInstance* insti = static_cast<IndepSetInstance*>(prob->inst);
+
+	// Add the keys of the vertices that are only in rhs
+	const size_t* vertex_hash_keys = insti->vertex_hash_keys;
+	intset.union_with(rhsi->intset, [&](int v) {
+		hash_val ^= vertex_hash_keys[v];
+	});
 }
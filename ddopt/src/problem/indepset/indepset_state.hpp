@@ -9,33 +9,73 @@
 #include "../problem.hpp"
 #include "../../util/intset.hpp"
 
+class IndepSetProblem; // forward declaration
+
 
 /** State for independent set */
-class IndepSetState : public State
+class IndepSetState final : public State
 {
 public:
-	IntSet intset;
+	IntSet intset;             /**< vertices that can still be selected, by position (see IndepSetInstance) */
+	size_t hash_val;           /**< XOR of the hash keys of the vertices in intset */
 
-	IndepSetState(IntSet _intset) : intset(_intset) {}
+	IndepSetState(IntSet _intset, const size_t* vertex_hash_keys) : intset(_intset)
+	{
+		compute_hash(vertex_hash_keys);
+	}
+
+	/** Empty state, to be filled by transition_into */
+	IndepSetState() : hash_val(0) {}
 
 	State* transition(Problem* prob, int var, int val);
 
-	void merge(Problem* prob, State* rhs)
+	/** Non-virtual transition used by TypedDDSolver (defined in indepset_problem.hpp) */
+	IndepSetState* transition(IndepSetProblem* prob, int var, int val);
+
+	/** Two-phase transition used by TypedDDSolver (defined in indepset_problem.hpp) */
+	bool transition_into(IndepSetProblem* prob, int var, int val, IndepSetState* successor) const;
+
+	void merge(Problem* prob, State* rhs);
+
+	State* clone() const
 	{
-		IndepSetState* rhsi = dynamic_cast<IndepSetState*>(rhs);
-		intset.union_with(rhsi->intset);
+		return new IndepSetState(*this);
 	}
 
 	bool equals_to(State* rhs)
 	{
 		IndepSetState* rhsi = dynamic_cast<IndepSetState*>(rhs);
-		return intset.equals_to(rhsi->intset);
+		return equals_to(rhsi);
+	}
+
+	bool equals_to(IndepSetState* rhs)
+	{
+		return intset.equals_to(rhs->intset);
 	}
 
 	bool less(const State& rhs) const
 	{
 		const IndepSetState& rhsi = dynamic_cast<const IndepSetState&>(rhs);
-		return intset.set < rhsi.intset.set;
+		return intset.less_than(rhsi.intset);
+	}
+
+	size_t hash() const
+	{
+		return hash_val;
+	}
+
+	/** Compute the hash from scratch */
+	void compute_hash(const size_t* vertex_hash_keys)
+	{
+		hash_val = 0;
+		for (int v = intset.get_first(); v != intset.get_end(); v = intset.get_next(v)) {
+			hash_val ^= vertex_hash_keys[v];
+		}
+	}
+
+	size_t get_memory_size() const
+	{
+		return sizeof(IndepSetState) + intset.get_heap_memory_size();
 	}
 
 	int get_size()
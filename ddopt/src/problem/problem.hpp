@@ -17,6 +17,11 @@
 class Problem
 {
 public:
+	typedef State StateType;   /**< type of the states of the problem; redefined by problems used with TypedDDSolver */
+
+	/** True if StateType implements the two-phase State::transition_into; redefined by problems that do */
+	static const bool probe_transitions = false;
+
 	Ordering*                     ordering;                    /**< ordering */
 	Merger*                       merger;                      /**< merging technique */
 	CompletionBound*              completion;                  /**< dual bound generator for pruning; may be NULL if unused */
@@ -47,7 +52,10 @@ public:
 	/** Callback during initialization */
 	virtual void cb_initialize() {}
 
-	/** Callback during creation of a new state */
+	/**
+	 * Callback during creation of a new state. Always called from a single thread in order of node creation, even with
+	 * multi-threaded construction, so implementations need not be thread-safe.
+	 */
 	virtual void cb_state_created(State* state) {}
 
 	/** Callback during removal of a state */
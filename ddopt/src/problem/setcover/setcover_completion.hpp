@@ -0,0 +1,56 @@
+/**
+ * Completion bounds for set covering
+ */
+
+#ifndef SETCOVER_COMPLETION_HPP_
+#define SETCOVER_COMPLETION_HPP_
+
+#include <vector>
+#include <limits>
+#include "../../core/completion.hpp"
+#include "../../util/util.hpp"
+#include "setcover_state.hpp"
+#include "setcover_problem.hpp"
+
+
+/**
+ * Total positive weight plus, for the uncovered row whose best variable is worst, the weight of that variable if
+ * negative: any completion takes a variable of each uncovered row. Positions must not be renumbered afterwards.
+ */
+class SetCoverRowCompletionBound : public CompletionBound
+{
+	double         positive_weight;     /**< sum of the positive weights */
+	vector<double> position_bound;      /**< largest nonpositive part of the weights of the variables of each row */
+
+public:
+
+	SetCoverRowCompletionBound(SetCoverProblem* prob)
+	{
+		BPInstance* inst = prob->instance;
+		const BPMatrix& matrix = inst->matrix;
+		positive_weight = 0;
+		for (int j = 0; j < inst->nvars; ++j) {
+			positive_weight += MAX(0, inst->weights[j]);
+		}
+		position_bound.resize(matrix.nrows);
+		for (int i = 0; i < matrix.nrows; ++i) {
+			double bound = -numeric_limits<double>::infinity();
+			for (int k = matrix.row_start[i]; k < matrix.row_start[i + 1]; ++k) {
+				bound = MAX(bound, MIN(0, inst->weights[matrix.row_ind[k]]));
+			}
+			position_bound[prob->row_position[i]] = bound;
+		}
+	}
+
+	double dual_bound(Instance* inst, Node* node, Node* parent)
+	{
+		SetCoverState* state = static_cast<SetCoverState*>(node->state);
+		double row_bound = 0;
+		for (int p = state->uncovered.get_first(); p != state->uncovered.get_end(); p = state->uncovered.get_next(p)) {
+			row_bound = MIN(row_bound, position_bound[p]);
+		}
+		return positive_weight + row_bound;
+	}
+};
+
+#endif /* SETCOVER_COMPLETION_HPP_ */
@@ -0,0 +1,26 @@
+/**
+ * Merging functions specific to set covering
+ */
+
+#include "setcover_mergers.hpp"
+#include "../../core/mergers.hpp"
+
+Merger* get_merger_by_id_setcover(int id, int width)
+{
+	// Read merge type; ids up to 5 are the same as for binary problems
+	switch (id) {
+	case 1:
+		return new MinLongestPathMerger(width);
+	case 2:
+		return new PairMinLongestPathMerger(width);
+	case 3:
+		return new ConsecutivePairLongestPathMerger(width);
+	case 4:
+		return new LexicographicMerger(width);
+	case 5:
+		return new RandomMerger(width);
+	case 6:
+		return new MinLongestPathUncoveredMerger(width);
+	}
+	return NULL;
+}
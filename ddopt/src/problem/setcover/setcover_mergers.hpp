@@ -0,0 +1,51 @@
+/**
+ * Merging functions specific to set covering
+ */
+
+#ifndef SETCOVER_MERGERS_HPP_
+#define SETCOVER_MERGERS_HPP_
+
+#include "../../core/merge.hpp"
+#include "setcover_state.hpp"
+
+
+/** Return a merger for set covering given an id */
+Merger* get_merger_by_id_setcover(int id, int width);
+
+
+/**
+ * Node comparator by longest path (decreasing order), then by number of uncovered rows (decreasing order) and global id
+ */
+struct CompareNodesLongestPathUncovered {
+	bool operator()(Node* nodeA, Node* nodeB) const
+	{
+		SetCoverState* stateA = static_cast<SetCoverState*>(nodeA->state);
+		SetCoverState* stateB = static_cast<SetCoverState*>(nodeB->state);
+		if (!DBL_EQ(nodeA->longest_path, nodeB->longest_path)) {
+			return nodeA->longest_path > nodeB->longest_path;
+		}
+		if (stateA->get_size() != stateB->get_size()) {
+			return stateA->get_size() > stateB->get_size();
+		}
+		return nodeA->global_id < nodeB->global_id;
+	}
+};
+
+
+// Merges the nodes with the smallest longest path and, among those, with the fewest uncovered rows, whose intersection
+// loses the fewest rows
+struct MinLongestPathUncoveredMerger : Merger {
+	MinLongestPathUncoveredMerger(int _width) : Merger(_width, "min_longest_path_uncovered") {}
+
+	void merge_layer(Problem* prob, int layer, vector<Node*>& nodes_layer)
+	{
+		merge_nodes_past_width_iteratively(prob, nodes_layer, width, CompareNodesLongestPathUncovered());
+	}
+
+	void restrict_layer(Problem* prob, int layer, vector<Node*>& nodes_layer)
+	{
+		drop_nodes_past_width(nodes_layer, width, CompareNodesLongestPathUncovered());
+	}
+};
+
+#endif // SETCOVER_MERGERS_HPP_
@@ -0,0 +1,80 @@
+/**
+ * Orderings for set covering
+ */
+
+#include <set>
+#include "setcover_orderings.hpp"
+#include "../bp/bp_orderings.hpp"
+#include "../../core/orderings.hpp"
+
+
+Ordering* get_ordering_by_id_setcover(int id, BPInstance* inst, Options& options)
+{
+	// Read ordering type; ids up to 4 are the same as for binary problems
+	switch (id) {
+	case 1:
+		return new RandomOrdering(inst);
+	case 2:
+		return new CuthillMcKeePairOrdering(inst);
+	case 3:
+		if (options.fixed_order_filename.empty()) {
+			cout << "Error: text file required for ordering\n\n";
+			exit(1);
+		}
+		return new FixedOrdering(inst, options.fixed_order_filename);
+	case 4:
+		return new NoOrdering();
+	case 5:
+		return new MinRowRemainingOrdering(inst);
+	}
+	return NULL;
+}
+
+
+void MinRowRemainingOrdering::construct_ordering()
+{
+	const BPMatrix& matrix = inst->matrix;
+
+	// Rows keyed by their number of variables not ordered yet; rows already taken have no key
+	vector<int> nleft(matrix.nrows);
+	set<pair<int,int>> rows_by_nleft;
+	for (int i = 0; i < matrix.nrows; ++i) {
+		nleft[i] = matrix.get_row_nnonz(i);
+		if (nleft[i] > 0) {
+			rows_by_nleft.insert(make_pair(nleft[i], i));
+		}
+	}
+
+	vector<bool> ordered(inst->nvars, false);
+	v_in_layer.clear();
+	while (!rows_by_nleft.empty()) {
+		int row = rows_by_nleft.begin()->second;
+		rows_by_nleft.erase(rows_by_nleft.begin());
+		nleft[row] = 0;
+
+		for (int k = matrix.row_start[row]; k < matrix.row_start[row + 1]; ++k) {
+			int var = matrix.row_ind[k];
+			if (ordered[var]) {
+				continue;
+			}
+			ordered[var] = true;
+			v_in_layer.push_back(var);
+
+			for (int l = matrix.col_start[var]; l < matrix.col_start[var + 1]; ++l) {
+				int i = matrix.col_ind[l];
+				if (nleft[i] > 0) {
+					rows_by_nleft.erase(make_pair(nleft[i], i));
+					if (--nleft[i] > 0) {
+						rows_by_nleft.insert(make_pair(nleft[i], i));
+					}
+				}
+			}
+		}
+	}
+
+	for (int var = 0; var < inst->nvars; ++var) {
+		if (!ordered[var]) {
+			v_in_layer.push_back(var);
+		}
+	}
+}
@@ -0,0 +1,51 @@
+/**
+ * Orderings for set covering
+ */
+
+#ifndef SETCOVER_ORDERINGS_HPP_
+#define SETCOVER_ORDERINGS_HPP_
+
+#include <vector>
+#include "../../core/order.hpp"
+#include "../../util/options.hpp"
+#include "../bp/bp_instance.hpp"
+
+using namespace std;
+
+
+/** Return an ordering for set covering given an id */
+Ordering* get_ordering_by_id_setcover(int id, BPInstance* inst, Options& options);
+
+
+/**
+ * Ordering that repeatedly takes the row with the fewest variables not ordered yet and appends these variables, so that
+ * rows are completed early and leave the states soon. Variables in no row come last.
+ */
+struct MinRowRemainingOrdering : Ordering {
+	BPInstance* inst;
+	vector<int> v_in_layer;   // variable at each layer
+
+	MinRowRemainingOrdering(BPInstance* _inst) : inst(_inst)
+	{
+		sprintf(name, "min-row-remaining");
+		construct_ordering();
+	}
+
+	int select_next_var(int layer)
+	{
+		assert(layer >= 0 && layer < inst->nvars);
+		return v_in_layer[layer];
+	}
+
+	bool is_static()
+	{
+		return true;
+	}
+
+private:
+
+	void construct_ordering();
+};
+
+
+#endif // SETCOVER_ORDERINGS_HPP_
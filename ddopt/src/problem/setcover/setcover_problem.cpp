@@ -0,0 +1,134 @@
+/**
+ * Set covering problem class
+ */
+
+#include <algorithm>
+#include "setcover_problem.hpp"
+#include "../../util/hash.hpp"
+#include "../../util/util.hpp"
+
+
+bool is_set_cover_instance(BPInstance* inst)
+{
+	const BPMatrix& matrix = inst->matrix;
+	if (matrix.nrows == 0) {
+		return false;
+	}
+	for (int i = 0; i < matrix.nrows; ++i) {
+		if (matrix.row_sense[i] != SENSE_GE || !DBL_EQ(matrix.row_rhs[i], 1) || matrix.get_row_nnonz(i) == 0) {
+			return false;
+		}
+		for (int k = matrix.row_start[i]; k < matrix.row_start[i + 1]; ++k) {
+			if (!DBL_EQ(matrix.row_coeffs[k], 1)) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+
+SetCoverProblem::SetCoverProblem(BPInstance* _inst, Options* _opts) : Problem(_inst, _opts)
+{
+	instance = static_cast<BPInstance*>(inst);
+	nrows = instance->matrix.nrows;
+	assert(is_set_cover_instance(instance));
+
+	// Positions are the row indices until renumbered
+	vector<int> row_in_position(nrows);
+	for (int i = 0; i < nrows; ++i) {
+		row_in_position[i] = i;
+	}
+	set_positions(row_in_position);
+	var_first_open.assign(instance->nvars, 0);
+	layer_positions = false;
+}
+
+
+void SetCoverProblem::cb_initialize()
+{
+	const BPMatrix& matrix = instance->matrix;
+	nremaining.resize(nrows);
+	for (int i = 0; i < nrows; ++i) {
+		nremaining[row_position[i]] = matrix.get_row_nnonz(i);
+	}
+	var_processed.assign(instance->nvars, false);
+}
+
+
+void SetCoverProblem::cb_layer_end(int current_var)
+{
+	const BPMatrix& matrix = instance->matrix;
+	for (int k = matrix.col_start[current_var]; k < matrix.col_start[current_var + 1]; ++k) {
+		assert(nremaining[col_positions[k]] > 0);
+		nremaining[col_positions[k]]--;
+	}
+	var_processed[current_var] = true;
+}
+
+
+void SetCoverProblem::renumber_for_ordering(Ordering* ordering)
+{
+	assert(ordering->is_static());
+	const BPMatrix& matrix = instance->matrix;
+	int nvars = instance->nvars;
+
+	vector<int> var_layer(nvars, -1);
+	for (int layer = 0; layer < nvars; layer++) {
+		int var = ordering->select_next_var(layer);
+		if (var < 0 || var >= nvars || var_layer[var] >= 0) {
+			cout << "Error: ordering is not a permutation of the variables" << endl;
+			exit(1);
+		}
+		var_layer[var] = layer;
+	}
+
+	// Order rows by the layer of their last variable
+	vector<int> row_last_layer(nrows, -1);
+	for (int i = 0; i < nrows; ++i) {
+		for (int k = matrix.row_start[i]; k < matrix.row_start[i + 1]; ++k) {
+			row_last_layer[i] = MAX(row_last_layer[i], var_layer[matrix.row_ind[k]]);
+		}
+	}
+	vector<int> row_in_position(nrows);
+	for (int i = 0; i < nrows; ++i) {
+		row_in_position[i] = i;
+	}
+	stable_sort(row_in_position.begin(), row_in_position.end(), [&](int a, int b) {
+		return row_last_layer[a] < row_last_layer[b];
+	});
+	set_positions(row_in_position);
+
+	// After the layer of a variable, only rows whose last variable comes later can be uncovered
+	int p = 0;
+	vector<int> layer_first_open(nvars);
+	for (int layer = 0; layer < nvars; layer++) {
+		while (p < nrows && row_last_layer[row_in_position[p]] <= layer) {
+			p++;
+		}
+		layer_first_open[layer] = p;
+	}
+	for (int var = 0; var < nvars; ++var) {
+		var_first_open[var] = layer_first_open[var_layer[var]];
+	}
+	layer_positions = true;
+}
+
+
+void SetCoverProblem::set_positions(const vector<int>& row_in_position)
+{
+	const BPMatrix& matrix = instance->matrix;
+
+	row_position.resize(nrows);
+	position_row = row_in_position;
+	position_hash_keys.resize(nrows);
+	for (int p = 0; p < nrows; ++p) {
+		row_position[row_in_position[p]] = p;
+		position_hash_keys[p] = hash_key(p);
+	}
+
+	col_positions.resize(matrix.col_ind.size());
+	for (int k = 0; k < (int) matrix.col_ind.size(); ++k) {
+		col_positions[k] = row_position[matrix.col_ind[k]];
+	}
+}
@@ -0,0 +1,185 @@
+/**
+ * Set covering problem class
+ */
+
+#ifndef SETCOVER_PROBLEM_HPP_
+#define SETCOVER_PROBLEM_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include "setcover_state.hpp"
+#include "../problem.hpp"
+#include "../bp/bp_instance.hpp"
+
+using namespace std;
+
+
+/** Return true if all rows of a binary program are set covering rows: sum of variables >= 1 */
+bool is_set_cover_instance(BPInstance* inst);
+
+
+/**
+ * Problem class for set covering, over a binary program whose rows are all set covering rows. The state is the set of
+ * uncovered rows: a 1-arc covers the rows of the variable and a 0-arc is infeasible if it leaves an uncovered row without
+ * unprocessed variables. Rows are identified in states by a position; with a static ordering, positions follow the layer
+ * of the last variable of each row, so that rows that must be covered by the current layer are dropped from the states.
+ *
+ * A variable that is the last one left for an uncovered row is forced to one. A 0-arc that forces a variable thus also
+ * covers the other rows of that variable, except the rows that force it, which stay uncovered to keep it forced. This
+ * keeps one state per set of feasible completions where the uncovered rows alone would tell apart states that only
+ * differ by rows of forced variables.
+ */
+class SetCoverProblem : public Problem
+{
+public:
+	typedef SetCoverState StateType;
+
+	static const bool probe_transitions = true;
+
+
+	BPInstance*        instance;            /**< casted instance for convenience */
+	int                nrows;               /**< number of rows */
+
+	vector<int32_t>    row_position;        /**< position of each row in the states */
+	vector<int32_t>    col_positions;       /**< positions of the rows of each variable, laid out as in matrix.col_ind */
+	vector<int32_t>    var_first_open;      /**< first position that can be uncovered after the layer of each variable */
+	vector<size_t>     position_hash_keys;  /**< hash key of each position */
+	vector<int32_t>    nremaining;          /**< number of unprocessed variables of the row at each position */
+	vector<int32_t>    position_row;        /**< row at each position */
+	vector<char>       var_processed;       /**< true for each variable whose layer has ended */
+	bool               layer_positions;     /**< true if renumbered for a static ordering (see renumber_for_ordering) */
+
+
+	SetCoverProblem(BPInstance* _inst, Options* _opts);
+
+	~SetCoverProblem()
+	{
+	}
+
+	SetCoverState* create_initial_state()
+	{
+		IntSet uncovered;
+		uncovered.resize(0, nrows - 1, true);
+
+		// Variables alone in a row are forced from the start (see transition_into)
+		const BPMatrix& matrix = instance->matrix;
+		for (int i = 0; i < nrows; ++i) {
+			if (matrix.get_row_nnonz(i) != 1) {
+				continue;
+			}
+			int var = matrix.row_ind[matrix.row_start[i]];
+			for (int k = matrix.col_start[var]; k < matrix.col_start[var + 1]; ++k) {
+				if (matrix.get_row_nnonz(matrix.col_ind[k]) > 1) {
+					uncovered.remove(col_positions[k]);
+				}
+			}
+		}
+		return new SetCoverState(uncovered, position_hash_keys.data());
+	}
+
+	void cb_initialize();
+
+	void cb_layer_end(int current_var);
+
+	bool expect_single_terminal()
+	{
+		return true;    // Decision diagram should be reduced
+	}
+
+	/** Number rows by the layer of their last variable in a static ordering */
+	void renumber_for_ordering(Ordering* ordering);
+
+private:
+
+	/** Set the positions of the rows and the structures over them */
+	void set_positions(const vector<int>& row_in_position);
+};
+
+
+inline SetCoverState* SetCoverState::transition(SetCoverProblem* prob, int var, int val)
+{
+	SetCoverState* new_state = new SetCoverState();
+	if (!transition_into(prob, var, val, new_state)) {
+		delete new_state;
+		return NULL;
+	}
+	return new_state;
+}
+
+
+inline bool SetCoverState::transition_into(SetCoverProblem* prob, int var, int val, SetCoverState* successor) const
+{
+	assert(val == 0 || val == 1);
+
+	const BPMatrix& matrix = prob->instance->matrix;
+	const int32_t* col_positions = prob->col_positions.data();
+	int begin = matrix.col_start[var];
+	int end = matrix.col_start[var + 1];
+
+	// Not taking the variable is infeasible if it is the last one left for an uncovered row
+	if (val == 0) {
+		const int32_t* nremaining = prob->nremaining.data();
+		for (int k = begin; k < end; ++k) {
+			int p = col_positions[k];
+			if (nremaining[p] == 1 && uncovered.contains(p)) {
+				return false;
+			}
+		}
+	}
+
+	// If positions follow the layers, rows whose last variable is this one are covered from now on
+	successor->uncovered.assign(uncovered, prob->var_first_open[var]);
+	successor->hash_val = hash_val;
+
+	// Cover the rows of the variable
+	const size_t* position_hash_keys = prob->position_hash_keys.data();
+	if (val == 1) {
+		for (int k = begin; k < end; ++k) {
+			int p = col_positions[k];
+			if (uncovered.contains(p)) {
+				successor->uncovered.remove(p);
+				successor->hash_val ^= position_hash_keys[p];
+			}
+		}
+		return true;
+	}
+
+	// Rows left with a single variable force it to one, which covers its other rows. Rows of variables forced before
+	// were already covered in this state, and covering rows forces no other variable.
+	const int32_t* nremaining = prob->nremaining.data();
+	for (int k = begin; k < end; ++k) {
+		int p = col_positions[k];
+		if (nremaining[p] != 2 || !successor->uncovered.contains(p)) {
+			continue;
+		}
+		int forced = -1;
+		int row = prob->position_row[p];
+		for (int r = matrix.row_start[row]; r < matrix.row_start[row + 1]; ++r) {
+			int j = matrix.row_ind[r];
+			if (j != var && !prob->var_processed[j]) {
+				forced = j;
+				break;
+			}
+		}
+		assert(forced >= 0);
+
+		// Keep the rows of the forced variable that have no other variable left
+		for (int l = matrix.col_start[forced]; l < matrix.col_start[forced + 1]; ++l) {
+			int q = col_positions[l];
+			if (!successor->uncovered.contains(q) || nremaining[q] == 1) {
+				continue;
+			}
+			if (nremaining[q] == 2 && find(col_positions + begin, col_positions + end, q) != col_positions + end) {
+				continue;
+			}
+			successor->uncovered.remove(q);
+			successor->hash_val ^= position_hash_keys[q];
+		}
+	}
+
+	return true;
+}
+
+
+#endif /* SETCOVER_PROBLEM_HPP_ */
@@ -0,0 +1,29 @@
+/**
+ * Set covering state
+ */
+
+#include "setcover_state.hpp"
+#include "setcover_problem.hpp"
+
+State* SetCoverState::transition(Problem* prob, int var, int val)
+{
+	SetCoverProblem* prob_sc = dynamic_cast<SetCoverProblem*>(prob);
+	if (prob_sc == NULL) {
+		cout << "Error: Using incompatible State and Problem" << endl;
+		exit(1);
+	}
+	return transition(prob_sc, var, val);
+}
+
+
+void SetCoverState::merge(Problem* prob, State* rhs)
+{
+	SetCoverState* rhss = dynamic_cast<SetCoverState*>(rhs);
+	SetCoverProblem* prob_sc = static_cast<SetCoverProblem*>(prob);
+
+	// A row stays uncovered only if it is uncovered in both states; remove the keys of the rows only in this state
+	const size_t* position_hash_keys = prob_sc->position_hash_keys.data();
+	uncovered.intersect_with(rhss->uncovered, [&](int p) {
+		hash_val ^= position_hash_keys[p];
+	});
+}
@@ -0,0 +1,94 @@
+/**
+ * Set covering state
+ */
+
+#ifndef SETCOVER_STATE_HPP_
+#define SETCOVER_STATE_HPP_
+
+#include "../state.hpp"
+#include "../problem.hpp"
+#include "../../util/intset.hpp"
+
+class SetCoverProblem; // forward declaration
+
+
+/** State for set covering: the rows not yet covered */
+class SetCoverState final : public State
+{
+public:
+	IntSet uncovered;          /**< rows not covered yet, by position (see SetCoverProblem) */
+	size_t hash_val;           /**< XOR of the hash keys of the positions in uncovered */
+
+	SetCoverState(IntSet _uncovered, const size_t* position_hash_keys) : uncovered(_uncovered)
+	{
+		compute_hash(position_hash_keys);
+	}
+
+	/** Empty state, to be filled by transition_into */
+	SetCoverState() : hash_val(0) {}
+
+	State* transition(Problem* prob, int var, int val);
+
+	/** Non-virtual transition used by TypedDDSolver (defined in setcover_problem.hpp) */
+	SetCoverState* transition(SetCoverProblem* prob, int var, int val);
+
+	/** Two-phase transition used by TypedDDSolver (defined in setcover_problem.hpp) */
+	bool transition_into(SetCoverProblem* prob, int var, int val, SetCoverState* successor) const;
+
+	void merge(Problem* prob, State* rhs);
+
+	State* clone() const
+	{
+		return new SetCoverState(*this);
+	}
+
+	bool equals_to(State* rhs)
+	{
+		SetCoverState* rhss = dynamic_cast<SetCoverState*>(rhs);
+		return equals_to(rhss);
+	}
+
+	bool equals_to(SetCoverState* rhs)
+	{
+		return uncovered.equals_to(rhs->uncovered);
+	}
+
+	bool less(const State& rhs) const
+	{
+		const SetCoverState& rhss = dynamic_cast<const SetCoverState&>(rhs);
+		return uncovered.less_than(rhss.uncovered);
+	}
+
+	size_t hash() const
+	{
+		return hash_val;
+	}
+
+	/** Compute the hash from scratch */
+	void compute_hash(const size_t* position_hash_keys)
+	{
+		hash_val = 0;
+		for (int p = uncovered.get_first(); p != uncovered.get_end(); p = uncovered.get_next(p)) {
+			hash_val ^= position_hash_keys[p];
+		}
+	}
+
+	size_t get_memory_size() const
+	{
+		return sizeof(SetCoverState) + uncovered.get_heap_memory_size();
+	}
+
+	int get_size()
+	{
+		return uncovered.get_size();
+	}
+
+	ostream& stream_write(ostream& os) const
+	{
+		os << uncovered;
+		return os;
+	}
+};
+
+
+#endif /* SETCOVER_STATE_HPP_ */
@@ -6,28 +6,85 @@
 #define STATE_HPP_
 
 #include <iostream>
+#include <cstddef>
+#include <cassert>
 #include "instance.hpp"
+#include "../util/slab.hpp"
 
 
 class Problem; // forward declaration; state implementations need to include problem header
 
+/**
+ * Abstract state. Concrete states that are used with TypedDDSolver should be declared final and may add non-virtual
+ * overloads of transition and equals_to taking their own problem and state types; the typed solver calls those
+ * directly, so they can be inlined without virtual calls or casts.
+ *
+ * Such states may also implement a two-phase transition, transition_into, if their problem sets probe_transitions. The
+ * typed solver then computes each child into a scratch state and looks it up in the node pool, and only allocates a
+ * state and a node for children with no equivalent state in the pool.
+ */
 class State
 {
 public:
 	virtual ~State() {}
 
-	/** Transition from given state with var set to val. Return NULL if no transition exists (i.e. infeasible). */
+	/** States are created and deleted in large numbers; allocate them from slabs (size is that of the derived class) */
+	static void* operator new(size_t size)
+	{
+		return slab_allocate(size);
+	}
+
+	static void operator delete(void* ptr, size_t size)
+	{
+		slab_deallocate(ptr, size);
+	}
+
+	/**
+	 * Transition from given state with var set to val. Return NULL if no transition exists (i.e. infeasible).
+	 * With multi-threaded construction, this may be called concurrently on distinct states, so it must not modify the
+	 * problem or instance.
+	 */
 	virtual State* transition(Problem* prob, int var, int val) = 0;
 
+	/** Return a copy of the state */
+	virtual State* clone() const = 0;
+
+	/**
+	 * Two-phase transition: write the state obtained with var set to val into successor, an existing state of the same
+	 * type, and return false if no transition exists. Successor is reused across calls, so this should not allocate
+	 * in most cases. Must be redefined (non-virtual, with the concrete types) by states whose problem sets
+	 * probe_transitions; it is never called otherwise.
+	 */
+	bool transition_into(Problem* prob, int var, int val, State* successor) const
+	{
+		assert(false);
+		return false;
+	}
+
 	/** Merging function between two states. This state becomes the merged state and the other state is left unchanged. */
 	virtual void merge(Problem* prob, State* rhs) = 0;
 
 	/** Equivalence function between two states. */
 	virtual bool equals_to(State* rhs) = 0;
 
-	/** Operator < needs to be defined for comparator in hash map */
+	/** Operator < needs to be defined for comparator in the ordered node pool */
 	virtual bool less(const State& rhs) const = 0;
 
+	/**
+	 * Hash of the state for the hashed node pool. Equivalent states (w.r.t. equals_to) must have the same hash.
+	 * This is called for every transition, so it should be cached in the state and updated incrementally.
+	 */
+	virtual size_t hash() const = 0;
+
+	/**
+	 * Approximate number of bytes used by the state, including memory it owns. Used to estimate the footprint of a DD
+	 * under a memory budget.
+	 */
+	virtual size_t get_memory_size() const
+	{
+		return sizeof(State);
+	}
+
 	/** Function for printing the state */
 	virtual std::ostream& stream_write(std::ostream& os) const = 0;
 
@@ -0,0 +1,52 @@
+/**
+ * Hashing utilities for incremental state hashes
+ */
+
+#ifndef HASH_HPP_
+#define HASH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+
+#define HASH_DOUBLE_SCALE 1e6     /**< doubles are rounded to this many units before hashing and comparing */
+
+
+/** Mix the bits of a 64-bit value (splitmix64 finalizer) */
+inline uint64_t hash_mix(uint64_t x)
+{
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/** Hash key of an element; XOR of keys of elements gives a hash of a set that can be updated element by element */
+inline size_t hash_key(uint64_t elem)
+{
+	return (size_t) hash_mix(elem);
+}
+
+/** Hash key of a pair of integers (e.g. variable and domain) */
+inline size_t hash_key(uint64_t first, uint64_t second)
+{
+	return (size_t) hash_mix(hash_mix(first) ^ second);
+}
+
+/**
+ * Point of the grid of 1 / HASH_DOUBLE_SCALE units nearest to a double. Doubles that are hashed with hash_key_double must
+ * be compared by their grid points, so that equal values always share the same key.
+ */
+inline int64_t round_to_hash_grid(double val)
+{
+	return (int64_t) llround(val * HASH_DOUBLE_SCALE);
+}
+
+/** Hash key of an integer and a double, taken by its grid point (see round_to_hash_grid) */
+inline size_t hash_key_double(uint64_t first, double val)
+{
+	return hash_key(first, (uint64_t) round_to_hash_grid(val));
+}
+
+
+#endif /* HASH_HPP_ */
@@ -1,6 +1,14 @@
 /**
  * Data structure to store positive sets of integers. Should be used in the cases where one needs to do fast intersections
  * and unions, and does not iterate on all elements too many times.
+ *
+ * The set is a bitset stored in 64-bit words. Sets of up to INTSET_INLINE_WORDS words are stored inline, so copying a
+ * small set (e.g. in a state transition) does not allocate; larger sets are allocated from slabs. The word kernels use
+ * AVX2 or AVX-512 when compiled for them (USE_NATIVE_ARCH=1 in the Makefile).
+ *
+ * Words are only stored from min on, which is a multiple of the word size. A set created with min 0 may be copied
+ * without its lower elements (see assign) to save memory and time when lower elements are known not to be in the set
+ * anymore; elements below min are not in the set.
  */
 
 #ifndef INTSET_HPP_
@@ -8,10 +16,24 @@
 
 #define NOT_COMPUTED -1     /**< indicates if the size was not computed */
 
-#include <boost/dynamic_bitset.hpp>
+#ifndef INTSET_INLINE_WORDS
+#define INTSET_INLINE_WORDS 4    /**< number of words stored inline (4 words hold sets of up to 256 elements) */
+#endif
+
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fstream>
+#if defined(__AVX2__) || defined(__AVX512VPOPCNTDQ__)
+#include <immintrin.h>
+#endif
+#include "slab.hpp"
+
+typedef uint64_t IntSetWord;
+
+#define INTSET_WORD_BITS 64
 
 
 /** Integer Set structure */
@@ -23,8 +45,14 @@ struct IntSet {
 	/** Empty constructor */
 	IntSet();
 
+	/** Copy constructor */
+	IntSet(const IntSet& other);
+
+	/** Destructor */
+	~IntSet();
+
 	/** Check if set contains element */
-	bool contains(int elem);
+	bool contains(int elem) const;
 
 	/** Add an element to the set */
 	void add(int elem);
@@ -60,10 +88,18 @@ struct IntSet {
 	void resize(int _min, int _max);
 
 	/** Take the union with another intset */
-	void union_with(IntSet& intset);
+	void union_with(const IntSet& intset);
+
+	/** Take the union with another intset, calling on_added(elem) for each element that was not in the set */
+	template<class Func>
+	void union_with(const IntSet& intset, Func on_added);
 
 	/** Take the intersection with another intset */
-	void intersect_with(IntSet& intset);
+	void intersect_with(const IntSet& intset);
+
+	/** Take the intersection with another intset, calling on_removed(elem) for each element removed from the set */
+	template<class Func>
+	void intersect_with(const IntSet& intset, Func on_removed);
 
 	/** Checks if one intersects with the other intset */
 	void does_intersect(IntSet& intset);
@@ -71,19 +107,41 @@ struct IntSet {
 	/** Assignment operator */
 	IntSet& operator=(const IntSet& rhs);
 
+	/** Make the set a copy of other without its elements below first, reusing the storage of the set if possible */
+	void assign(const IntSet& other, int first);
+
 	/** Returns if set is a subset of another */
-	bool is_subset(const IntSet& other);
+	bool is_subset(const IntSet& other) const;
 
 	/** Returns if one set equals another */
-	bool equals_to(const IntSet& other);
+	bool equals_to(const IntSet& other) const;
+
+	/** Lexicographic comparison, from the highest element down */
+	bool less_than(const IntSet& other) const;
+
+	/** Bytes allocated outside of the structure (zero if the set is stored inline) */
+	size_t get_heap_memory_size() const;
 
 	// parameters
 
-	boost::dynamic_bitset<>     set;            /**< bitvector representing the set */
+	IntSetWord*                 words;          /**< words of the bitset: inline_words or a slab-allocated block */
+	IntSetWord                  inline_words[INTSET_INLINE_WORDS];
+	int                         nwords;         /**< number of words, from min; bits beyond max are always zero */
 	const int                   end;            /**< position beyond end of the set */
 	int                         size;           /**< number of elements in the set */
 	int                         min;            /**< minimum possible element of the set */
 	int                         max;            /**< maximum possible element of the set */
+
+private:
+
+	/** Set the number of words, reallocating if needed; the contents of the words are undefined */
+	void allocate_words(int _nwords);
+
+	/** Lower min to the given multiple of the word size, keeping the elements */
+	void extend_down(int _min);
+
+	/** Zero the bits of the last word beyond max */
+	void clear_tail();
 };
 
 
@@ -93,12 +151,136 @@ struct IntSet {
 struct IntSetLexLessThan {
 	bool operator()(const IntSet* setA, const IntSet* setB) const
 	{
-		return setA->set < setB->set;
+		return setA->less_than(*setB);
 	}
 };
 
 
 
+/**
+ * -----------------------------------------------
+ * Word kernels
+ * -----------------------------------------------
+ */
+
+/** a &= b */
+inline void intset_words_and(IntSetWord* a, const IntSetWord* b, int n)
+{
+	int i = 0;
+#ifdef __AVX2__
+	for (; i + 4 <= n; i += 4) {
+		__m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+		__m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+		_mm256_storeu_si256((__m256i*) (a + i), _mm256_and_si256(va, vb));
+	}
+#endif
+	for (; i < n; ++i) {
+		a[i] &= b[i];
+	}
+}
+
+/** a |= b */
+inline void intset_words_or(IntSetWord* a, const IntSetWord* b, int n)
+{
+	int i = 0;
+#ifdef __AVX2__
+	for (; i + 4 <= n; i += 4) {
+		__m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+		__m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+		_mm256_storeu_si256((__m256i*) (a + i), _mm256_or_si256(va, vb));
+	}
+#endif
+	for (; i < n; ++i) {
+		a[i] |= b[i];
+	}
+}
+
+/** Return true if a & ~b is empty, i.e. a is a subset of b */
+inline bool intset_words_andnot_empty(const IntSetWord* a, const IntSetWord* b, int n)
+{
+	int i = 0;
+#ifdef __AVX2__
+	for (; i + 4 <= n; i += 4) {
+		__m256i va = _mm256_loadu_si256((const __m256i*) (a + i));
+		__m256i vb = _mm256_loadu_si256((const __m256i*) (b + i));
+		if (!_mm256_testc_si256(vb, va)) {    // tests (~b & a) == 0
+			return false;
+		}
+	}
+#endif
+	for (; i < n; ++i) {
+		if (a[i] & ~b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Number of bits set */
+inline int intset_words_count(const IntSetWord* a, int n)
+{
+	int count = 0;
+	int i = 0;
+#ifdef __AVX512VPOPCNTDQ__
+	__m512i acc = _mm512_setzero_si512();
+	for (; i + 8 <= n; i += 8) {
+		acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(_mm512_loadu_si512((const void*) (a + i))));
+	}
+	count = (int) _mm512_reduce_add_epi64(acc);
+#endif
+	for (; i < n; ++i) {
+		count += __builtin_popcountll(a[i]);
+	}
+	return count;
+}
+
+/** Return true if a == b */
+inline bool intset_words_equal(const IntSetWord* a, const IntSetWord* b, int n)
+{
+	int i = 0;
+#ifdef __AVX2__
+	for (; i + 4 <= n; i += 4) {
+		__m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*) (a + i)),
+		                                _mm256_loadu_si256((const __m256i*) (b + i)));
+		if (!_mm256_testz_si256(diff, diff)) {
+			return false;
+		}
+	}
+#endif
+	for (; i < n; ++i) {
+		if (a[i] != b[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Return true if a < b, comparing words from the most significant down */
+inline bool intset_words_less(const IntSetWord* a, const IntSetWord* b, int n)
+{
+	int i = n - 1;
+#ifdef __AVX2__
+	// skip equal groups of four words
+	for (; i >= 3; i -= 4) {
+		__m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i*) (a + i - 3)),
+		                                _mm256_loadu_si256((const __m256i*) (b + i - 3)));
+		if (_mm256_movemask_epi8(eq) != -1) {
+			break;
+		}
+	}
+#endif
+	for (; i >= 0; --i) {
+		if (a[i] != b[i]) {
+			return a[i] < b[i];
+		}
+	}
+	return false;
+}
+
+
+
+
+
 /**
  * -----------------------------------------------
  * Inline implementations
@@ -108,7 +290,7 @@ struct IntSetLexLessThan {
 /**
  * Constructor
  */
-inline IntSet::IntSet(int _min, int _max, bool _filled) : end((int)set.npos)
+inline IntSet::IntSet(int _min, int _max, bool _filled) : words(inline_words), nwords(0), end(-1)
 {
 	resize(_min, _max, _filled);
 	size = NOT_COMPUTED;
@@ -117,17 +299,88 @@ inline IntSet::IntSet(int _min, int _max, bool _filled) : end((int)set.npos)
 /**
  * Empty constructor
  */
-inline IntSet::IntSet() : end((int)set.npos)
+inline IntSet::IntSet() : words(inline_words), nwords(0), end(-1), size(0), min(0), max(-1)
+{
+}
+
+/**
+ * Copy constructor
+ */
+inline IntSet::IntSet(const IntSet& other) : words(inline_words), nwords(0), end(-1), size(other.size), min(other.min),
+	max(other.max)
+{
+	allocate_words(other.nwords);
+	memcpy(words, other.words, nwords * sizeof(IntSetWord));
+}
+
+/**
+ * Destructor
+ */
+inline IntSet::~IntSet()
+{
+	if (words != inline_words) {
+		slab_deallocate(words, nwords * sizeof(IntSetWord));
+	}
+}
+
+/**
+ * Set the number of words, reallocating if needed
+ */
+inline void IntSet::allocate_words(int _nwords)
+{
+	if (_nwords == nwords) {
+		return;
+	}
+	if (words != inline_words) {
+		slab_deallocate(words, nwords * sizeof(IntSetWord));
+	}
+	nwords = _nwords;
+	if (nwords <= INTSET_INLINE_WORDS) {
+		words = inline_words;
+	} else {
+		words = static_cast<IntSetWord*>(slab_allocate(nwords * sizeof(IntSetWord)));
+	}
+}
+
+/**
+ * Lower min to the given multiple of the word size, keeping the elements
+ */
+inline void IntSet::extend_down(int _min)
+{
+	assert(_min <= min && _min % INTSET_WORD_BITS == 0);
+	if (_min == min) {
+		return;
+	}
+	IntSet original(*this);
+	int shift = (min - _min) / INTSET_WORD_BITS;
+	allocate_words(original.nwords + shift);
+	memset(words, 0, shift * sizeof(IntSetWord));
+	memcpy(words + shift, original.words, original.nwords * sizeof(IntSetWord));
+	min = _min;
+}
+
+/**
+ * Zero the bits of the last word beyond max
+ */
+inline void IntSet::clear_tail()
 {
+	int nbits = max - min + 1;
+	if (nbits % INTSET_WORD_BITS != 0) {
+		words[nwords - 1] &= (((IntSetWord) 1) << (nbits % INTSET_WORD_BITS)) - 1;
+	}
 }
 
 /**
  * Add an element to the set
  */
-inline bool IntSet::contains(int elem)
+inline bool IntSet::contains(int elem) const
 {
-	assert(elem >= min && elem <= max);
-	return (set.test(elem));
+	assert(elem <= max);
+	if (elem < min) {
+		return false;
+	}
+	elem -= min;
+	return (words[elem / INTSET_WORD_BITS] >> (elem % INTSET_WORD_BITS)) & 1;
 }
 
 
@@ -137,15 +390,20 @@ inline bool IntSet::contains(int elem)
 inline void IntSet::add(int elem)
 {
 	assert(elem >= min && elem <= max);
-	set.set(elem, true);
+	elem -= min;
+	words[elem / INTSET_WORD_BITS] |= ((IntSetWord) 1) << (elem % INTSET_WORD_BITS);
 	size = NOT_COMPUTED;
 }
 
 /** Remove element, if it is contained */
 inline void IntSet::remove(int elem)
 {
-	assert(elem >= min && elem <= max);
-	set.set(elem, false);
+	assert(elem <= max);
+	if (elem < min) {
+		return;
+	}
+	elem -= min;
+	words[elem / INTSET_WORD_BITS] &= ~(((IntSetWord) 1) << (elem % INTSET_WORD_BITS));
 	size = NOT_COMPUTED;
 }
 
@@ -154,7 +412,12 @@ inline void IntSet::remove(int elem)
  */
 inline int IntSet::get_first() const
 {
-	return (set.find_first());
+	for (int i = 0; i < nwords; ++i) {
+		if (words[i] != 0) {
+			return min + i * INTSET_WORD_BITS + __builtin_ctzll(words[i]);
+		}
+	}
+	return end;
 }
 
 /**
@@ -162,8 +425,25 @@ inline int IntSet::get_first() const
  */
 inline int IntSet::get_next(int elem) const
 {
-	assert(elem >= min && elem <= max);
-	return (set.find_next(elem));
+	assert(elem <= max);
+	if (elem < min) {
+		return get_first();
+	}
+	int pos = elem + 1 - min;
+	int i = pos / INTSET_WORD_BITS;
+	if (i >= nwords) {
+		return end;
+	}
+	IntSetWord word = (pos % INTSET_WORD_BITS == 0) ? words[i] : (words[i] >> (pos % INTSET_WORD_BITS));
+	if (word != 0) {
+		return min + pos + __builtin_ctzll(word);
+	}
+	for (++i; i < nwords; ++i) {
+		if (words[i] != 0) {
+			return min + i * INTSET_WORD_BITS + __builtin_ctzll(words[i]);
+		}
+	}
+	return end;
 }
 
 /**
@@ -179,7 +459,7 @@ inline int IntSet::get_end() const
  */
 inline void IntSet::clear()
 {
-	set.reset();
+	memset(words, 0, nwords * sizeof(IntSetWord));
 	size = 0;
 }
 
@@ -189,15 +469,41 @@ inline void IntSet::clear()
  */
 inline IntSet& IntSet::operator=(const IntSet& rhs)
 {
-	assert(rhs.max == max && rhs.min == min);
+	assert(rhs.max == max);
 	if (this != &rhs) {
-		set = rhs.set;
+		allocate_words(rhs.nwords);
+		memcpy(words, rhs.words, nwords * sizeof(IntSetWord));
+		min = rhs.min;
 		size = NOT_COMPUTED;
 	}
 	return *this;
 }
 
 
+/**
+ * Make the set a copy of other without its elements below first, reusing the storage of the set if possible
+ */
+inline void IntSet::assign(const IntSet& other, int first)
+{
+	assert(this != &other);
+	int skip = 0;
+	if (first > other.min) {
+		skip = (first - other.min) / INTSET_WORD_BITS;
+		if (skip > other.nwords) {
+			skip = other.nwords;
+		}
+	}
+	min = other.min + skip * INTSET_WORD_BITS;
+	max = other.max;
+	allocate_words(other.nwords - skip);
+	memcpy(words, other.words + skip, nwords * sizeof(IntSetWord));
+	if (nwords > 0 && first > min) {
+		words[0] &= ~((((IntSetWord) 1) << (first - min)) - 1);
+	}
+	size = (first <= other.min) ? other.size : NOT_COMPUTED;
+}
+
+
 /**
  * Resize
  */
@@ -211,12 +517,12 @@ inline void IntSet::resize(int _min, int _max, bool _filled)
 	min = _min;
 	max = _max;
 
-	set.resize(max - min + 1);
+	allocate_words((max - min + INTSET_WORD_BITS) / INTSET_WORD_BITS);
 
 	if (_filled) {
-		set.set();
+		add_all_elements();
 	} else {
-		set.reset();
+		clear();
 	}
 
 	size = NOT_COMPUTED;
@@ -233,10 +539,19 @@ inline void IntSet::resize(int _min, int _max)
 		exit(1);
 	}
 
+	IntSet original(*this);
+	int shift = (original.min - _min) / INTSET_WORD_BITS;
+
 	min = _min;
 	max = _max;
 
-	set.resize(max - min + 1);
+	allocate_words((max - min + INTSET_WORD_BITS) / INTSET_WORD_BITS);
+	memset(words, 0, nwords * sizeof(IntSetWord));
+	if (shift < nwords) {
+		int ncopy = (original.nwords < nwords - shift) ? original.nwords : nwords - shift;
+		memcpy(words + shift, original.words, ncopy * sizeof(IntSetWord));
+	}
+	clear_tail();
 
 	size = NOT_COMPUTED;
 }
@@ -245,18 +560,70 @@ inline void IntSet::resize(int _min, int _max)
 /**
  * Take the union with another intset
  */
-inline void IntSet::union_with(IntSet& intset)
+inline void IntSet::union_with(const IntSet& intset)
 {
-	set |= intset.set;
+	assert(intset.max == max);
+	if (intset.min < min) {
+		extend_down(intset.min);
+	}
+	int shift = (intset.min - min) / INTSET_WORD_BITS;
+	intset_words_or(words + shift, intset.words, intset.nwords);
+	size = NOT_COMPUTED;
+}
+
+/**
+ * Take the union with another intset, calling on_added(elem) for each element that was not in the set
+ */
+template<class Func>
+inline void IntSet::union_with(const IntSet& intset, Func on_added)
+{
+	assert(intset.max == max);
+	if (intset.min < min) {
+		extend_down(intset.min);
+	}
+	int shift = (intset.min - min) / INTSET_WORD_BITS;
+	for (int i = 0; i < intset.nwords; ++i) {
+		IntSetWord added = intset.words[i] & ~words[shift + i];
+		while (added != 0) {
+			on_added(intset.min + i * INTSET_WORD_BITS + __builtin_ctzll(added));
+			added &= added - 1;
+		}
+		words[shift + i] |= intset.words[i];
+	}
 	size = NOT_COMPUTED;
 }
 
 /**
  * Take the intersection with another intset
  */
-inline void IntSet::intersect_with(IntSet& intset)
+inline void IntSet::intersect_with(const IntSet& intset)
 {
-	set &= intset.set;
+	assert(intset.max == max);
+	int nbelow = (intset.min > min) ? (intset.min - min) / INTSET_WORD_BITS : 0;
+	int shift = (min > intset.min) ? (min - intset.min) / INTSET_WORD_BITS : 0;
+	memset(words, 0, nbelow * sizeof(IntSetWord));
+	intset_words_and(words + nbelow, intset.words + shift, nwords - nbelow);
+	size = NOT_COMPUTED;
+}
+
+/**
+ * Take the intersection with another intset, calling on_removed(elem) for each element removed from the set
+ */
+template<class Func>
+inline void IntSet::intersect_with(const IntSet& intset, Func on_removed)
+{
+	assert(intset.max == max);
+	int nbelow = (intset.min > min) ? (intset.min - min) / INTSET_WORD_BITS : 0;
+	int shift = (min > intset.min) ? (min - intset.min) / INTSET_WORD_BITS : 0;
+	for (int i = 0; i < nwords; ++i) {
+		IntSetWord mask = (i < nbelow) ? 0 : intset.words[shift + i - nbelow];
+		IntSetWord removed = words[i] & ~mask;
+		while (removed != 0) {
+			on_removed(min + i * INTSET_WORD_BITS + __builtin_ctzll(removed));
+			removed &= removed - 1;
+		}
+		words[i] &= mask;
+	}
 	size = NOT_COMPUTED;
 }
 
@@ -264,7 +631,7 @@ inline void IntSet::intersect_with(IntSet& intset)
 inline int IntSet::get_size()
 {
 	if (size == NOT_COMPUTED) {
-		size = set.count();
+		size = intset_words_count(words, nwords);
 	}
 	return size;
 }
@@ -272,7 +639,7 @@ inline int IntSet::get_size()
 /** Get the allocated size of the set */
 inline int IntSet::get_allocated_size()
 {
-	return set.size();
+	return max - min + 1;
 }
 
 /**
@@ -280,8 +647,13 @@ inline int IntSet::get_allocated_size()
  */
 inline void IntSet::add_all_elements()
 {
-	set.set();
-	size = set.size();
+	if (nwords == 0) {
+		size = 0;
+		return;
+	}
+	memset(words, 0xff, nwords * sizeof(IntSetWord));
+	clear_tail();
+	size = max - min + 1;
 }
 
 
@@ -304,17 +676,74 @@ inline std::ostream& operator<<(std::ostream& os, const IntSet& intset)
 /**
  * Returns if set is a subset of another
  */
-inline bool IntSet::is_subset(const IntSet& other)
+inline bool IntSet::is_subset(const IntSet& other) const
 {
-	return set.is_subset_of(other.set);
+	assert(other.max == max);
+	int nbelow = (other.min > min) ? (other.min - min) / INTSET_WORD_BITS : 0;
+	int shift = (min > other.min) ? (min - other.min) / INTSET_WORD_BITS : 0;
+	for (int i = 0; i < nbelow; ++i) {
+		if (words[i] != 0) {
+			return false;
+		}
+	}
+	return intset_words_andnot_empty(words + nbelow, other.words + shift, nwords - nbelow);
 }
 
 /**
  * Returns if one is equal to the other
  */
-inline bool IntSet::equals_to(const IntSet& other)
+inline bool IntSet::equals_to(const IntSet& other) const
+{
+	if (min == other.min) {
+		return nwords == other.nwords && intset_words_equal(words, other.words, nwords);
+	}
+	// Lower words of the set with the lower min must be empty
+	const IntSet& lower = (min < other.min) ? *this : other;
+	const IntSet& upper = (min < other.min) ? other : *this;
+	int nbelow = (upper.min - lower.min) / INTSET_WORD_BITS;
+	for (int i = 0; i < nbelow; ++i) {
+		if (lower.words[i] != 0) {
+			return false;
+		}
+	}
+	return lower.nwords - nbelow == upper.nwords && intset_words_equal(lower.words + nbelow, upper.words, upper.nwords);
+}
+
+/**
+ * Lexicographic comparison, from the highest element down
+ */
+inline bool IntSet::less_than(const IntSet& other) const
+{
+	assert(other.max == max);
+	if (min == other.min) {
+		return intset_words_less(words, other.words, nwords);
+	}
+	// Compare the common words, then the set with the lower min is larger if it has an element below the other min
+	const IntSet& lower = (min < other.min) ? *this : other;
+	const IntSet& upper = (min < other.min) ? other : *this;
+	int nbelow = (upper.min - lower.min) / INTSET_WORD_BITS;
+	const IntSetWord* a = (min < other.min) ? words + nbelow : words;
+	const IntSetWord* b = (min < other.min) ? other.words : other.words + nbelow;
+	if (intset_words_less(a, b, upper.nwords)) {
+		return true;
+	}
+	if (intset_words_less(b, a, upper.nwords)) {
+		return false;
+	}
+	for (int i = 0; i < nbelow; ++i) {
+		if (lower.words[i] != 0) {
+			return &lower == &other;
+		}
+	}
+	return false;
+}
+
+/**
+ * Bytes allocated outside of the structure
+ */
+inline size_t IntSet::get_heap_memory_size() const
 {
-	return (set == other.set);
+	return (words != inline_words) ? nwords * sizeof(IntSetWord) : 0;
 }
 
 
@@ -13,6 +13,7 @@ struct Options {
 
 	// Options on what should be run
 	bool   generate_cuts                        = true;    /**< generates cuts from DDs; false is equivalent to setting limit_ncuts to zero */
+	bool   bnb                                  = false;   /**< solve with DD-based branch-and-bound instead of the IP solver (see DDBranchAndBound) */
 
 	// General IP options (unrelated to DDs)
 	int    mip_cuts                             = -1;      /**< setting for MIP cuts, following CPLEX settings (-1: disabled, 0: automatic, 2: aggressive) */
@@ -43,9 +44,23 @@ struct Options {
 	string fixed_order_filename                 = "fixed_order.txt";  /**< input file for a fixed order for the DD */
 	double order_rand_min_state_prob            = 0.8;     /**< probability for the randomized min in state ordering */
 	bool   delete_old_states                    = true;    /**< free states from nodes of previous layers to reduce memory usage */
+	bool   reduce_dd                            = false;   /**< reduce the DD after construction (see BDD::reduce) */
+	int    refine_nodes                         = 0;       /**< maximum number of nodes added by refinement after construction (see DDRefiner) */
+	double refine_time_limit                    = -1;      /**< time limit in seconds for refinement (-1 means no limit) */
+	int    restricted_width                     = 0;       /**< width of restricted DD built for a primal bound before the relaxed DD (0 means none) */
+	bool   ordered_node_pool                    = false;   /**< use an ordered map instead of a hash table as node pool (reproduces original node order; states are not renumbered by layer) */
+	int    nthreads                             = 1;       /**< number of threads used to expand layers during DD construction */
+	int    memory_budget                        = 0;       /**< memory budget in MB for DD construction; width is chosen per layer to fit it (0 means no budget) */
+	int    bp_prop_budget                       = -1;      /**< maximum number of rows scanned per domain propagation in binary problems (-1 means until fixpoint) */
+	bool   bp_setcover_state                    = true;    /**< solve binary problems whose rows are all set covering rows with set covering states */
+
+	// DD-based branch-and-bound
+	int    bnb_threads                          = 1;       /**< number of threads for branch-and-bound */
+	double bnb_time_limit                       = -1;      /**< wall-clock time limit in seconds for branch-and-bound (-1 means no limit) */
 
 	// Output options
 	bool   quiet                                = false;   /**< do not output DD construction information */
+	string trace_filename                       = "";      /**< write a per-layer construction trace as JSON Lines to this file (empty means no trace) */
 
 };
 
@@ -0,0 +1,109 @@
+/**
+ * Utilities for running work in multiple threads
+ */
+
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <thread>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+
+/**
+ * Run func(thread_idx) for thread_idx = 0, ..., nthreads-1 in separate threads and wait until all of them are done.
+ * Index 0 runs in the calling thread.
+ */
+inline void run_in_parallel(int nthreads, const function<void(int)>& func)
+{
+	vector<thread> threads;
+	for (int t = 1; t < nthreads; ++t) {
+		threads.push_back(thread(func, t));
+	}
+	func(0);
+	for (thread& t : threads) {
+		t.join();
+	}
+}
+
+
+/**
+ * Work-stealing queue of tasks: each thread has its own deque, takes its tasks from the back (most recent first) and,
+ * if it has none, steals from the front of the deques of other threads (oldest first). Keeps count of tasks that are
+ * pushed but not finished, so that threads can tell when no more work can appear.
+ */
+template<class T>
+class WorkStealingQueue
+{
+public:
+
+	WorkStealingQueue(int nthreads) : deques(nthreads), locks(nthreads), npending(0) {}
+
+	/** Add a task to the deque of thread t */
+	void push(int t, const T& task)
+	{
+		npending++;
+		lock_guard<mutex> guard(locks[t]);
+		deques[t].push_back(task);
+	}
+
+	/** Take a task for thread t, from its own deque or stolen from another one; return false if none is available */
+	bool pop(int t, T& task)
+	{
+		{
+			lock_guard<mutex> guard(locks[t]);
+			if (!deques[t].empty()) {
+				task = deques[t].back();
+				deques[t].pop_back();
+				return true;
+			}
+		}
+		int nthreads = deques.size();
+		for (int k = 1; k < nthreads; ++k) {
+			int victim = (t + k) % nthreads;
+			lock_guard<mutex> guard(locks[victim]);
+			if (!deques[victim].empty()) {
+				task = deques[victim].front();
+				deques[victim].pop_front();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Mark a task taken with pop as finished; tasks it pushed must be pushed before */
+	void finish()
+	{
+		npending--;
+	}
+
+	/** True if all tasks pushed are finished */
+	bool done() const
+	{
+		return npending == 0;
+	}
+
+	/** Remove all remaining tasks and append them to the given vector (not thread-safe) */
+	void extract_all(vector<T>& tasks)
+	{
+		for (deque<T>& d : deques) {
+			tasks.insert(tasks.end(), d.begin(), d.end());
+			npending -= d.size();
+			d.clear();
+		}
+	}
+
+private:
+
+	vector<deque<T>>  deques;     /**< tasks of each thread */
+	vector<mutex>     locks;      /**< lock of each deque */
+	atomic<int>       npending;   /**< number of tasks pushed and not finished */
+};
+
+
+#endif /* PARALLEL_HPP_ */
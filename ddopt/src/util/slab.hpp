@@ -0,0 +1,183 @@
+/**
+ * Slab allocator for small objects created in large numbers during DD construction (nodes, states, node data)
+ */
+
+#ifndef SLAB_HPP_
+#define SLAB_HPP_
+
+#include <cstddef>
+#include <new>
+#include <mutex>
+
+using namespace std;
+
+#define SLAB_SIZE_CLASS          16      /**< block sizes are multiples of this */
+#define SLAB_MAX_BLOCK_SIZE      512     /**< larger objects are allocated with the global operator new */
+#define SLAB_NCLASSES            (SLAB_MAX_BLOCK_SIZE / SLAB_SIZE_CLASS)
+#define SLAB_BYTES               (64 * 1024)  /**< size of a slab carved into blocks */
+#define SLAB_CACHE_BATCH         128     /**< number of blocks moved at a time between thread caches and the shared pool */
+
+
+/** Free block, linked through its first bytes */
+struct SlabFreeBlock {
+	SlabFreeBlock* next;
+};
+
+
+/**
+ * Pool of blocks of a single size shared by all threads. Slabs are never returned to the system; freed blocks are
+ * recycled through a free list.
+ */
+class SlabPool
+{
+public:
+	SlabPool() : free_list(NULL) {}
+
+	/** Move up to n free blocks to the given list, carving a new slab if none is free; return the number moved */
+	int take(size_t size, int n, SlabFreeBlock*& list)
+	{
+		lock_guard<mutex> guard(lock);
+		if (free_list == NULL) {
+			carve_slab(size);
+		}
+		int ntaken = 0;
+		while (ntaken < n && free_list != NULL) {
+			SlabFreeBlock* block = free_list;
+			free_list = block->next;
+			block->next = list;
+			list = block;
+			ntaken++;
+		}
+		return ntaken;
+	}
+
+	/** Return a list of blocks, given from head to tail, to the pool */
+	void give(SlabFreeBlock* head, SlabFreeBlock* tail)
+	{
+		lock_guard<mutex> guard(lock);
+		tail->next = free_list;
+		free_list = head;
+	}
+
+private:
+	mutex               lock;
+	SlabFreeBlock*      free_list;
+
+	/** Allocate a new slab and add its blocks of the given size to the free list */
+	void carve_slab(size_t block_size)
+	{
+		char* slab = static_cast<char*>(::operator new(SLAB_BYTES));
+		int nblocks = SLAB_BYTES / block_size;
+		for (int i = nblocks - 1; i >= 0; --i) {
+			SlabFreeBlock* block = reinterpret_cast<SlabFreeBlock*>(slab + i * block_size);
+			block->next = free_list;
+			free_list = block;
+		}
+	}
+};
+
+
+/**
+ * Per-thread cache of free blocks for each size class, so that allocations and deallocations usually do not lock.
+ * Blocks go back to the shared pools when a cache grows too large and when the thread exits.
+ */
+class SlabThreadCache
+{
+public:
+	SlabThreadCache()
+	{
+		for (int c = 0; c < SLAB_NCLASSES; ++c) {
+			free_list[c] = NULL;
+			nfree[c] = 0;
+		}
+	}
+
+	~SlabThreadCache()
+	{
+		for (int c = 0; c < SLAB_NCLASSES; ++c) {
+			release(c, nfree[c]);
+		}
+	}
+
+	void* allocate(int c)
+	{
+		if (free_list[c] == NULL) {
+			nfree[c] += get_pools()[c].take((c + 1) * SLAB_SIZE_CLASS, SLAB_CACHE_BATCH, free_list[c]);
+		}
+		SlabFreeBlock* block = free_list[c];
+		free_list[c] = block->next;
+		nfree[c]--;
+		return block;
+	}
+
+	void deallocate(void* ptr, int c)
+	{
+		SlabFreeBlock* block = static_cast<SlabFreeBlock*>(ptr);
+		block->next = free_list[c];
+		free_list[c] = block;
+		nfree[c]++;
+		if (nfree[c] >= 2 * SLAB_CACHE_BATCH) {
+			release(c, SLAB_CACHE_BATCH);
+		}
+	}
+
+private:
+	SlabFreeBlock*      free_list[SLAB_NCLASSES];
+	int                 nfree[SLAB_NCLASSES];
+
+	/** Return n blocks of class c to the shared pool */
+	void release(int c, int n)
+	{
+		if (n == 0) {
+			return;
+		}
+		SlabFreeBlock* head = free_list[c];
+		SlabFreeBlock* tail = head;
+		for (int i = 1; i < n; ++i) {
+			tail = tail->next;
+		}
+		free_list[c] = tail->next;
+		nfree[c] -= n;
+		get_pools()[c].give(head, tail);
+	}
+
+	/** Shared pools, one per size class; never destroyed since blocks may be freed during static destruction */
+	static SlabPool* get_pools()
+	{
+		static SlabPool* pools = new SlabPool[SLAB_NCLASSES];
+		return pools;
+	}
+};
+
+
+/** Cache of the calling thread */
+inline SlabThreadCache& get_slab_thread_cache()
+{
+	thread_local SlabThreadCache cache;
+	return cache;
+}
+
+/** Allocate a block of at least the given size */
+inline void* slab_allocate(size_t size)
+{
+	if (size > SLAB_MAX_BLOCK_SIZE || size == 0) {
+		return ::operator new(size);
+	}
+	return get_slab_thread_cache().allocate((size - 1) / SLAB_SIZE_CLASS);
+}
+
+/** Free a block allocated with slab_allocate; size must be the same as in the allocation */
+inline void slab_deallocate(void* ptr, size_t size)
+{
+	if (ptr == NULL) {
+		return;
+	}
+	if (size > SLAB_MAX_BLOCK_SIZE || size == 0) {
+		::operator delete(ptr);
+		return;
+	}
+	get_slab_thread_cache().deallocate(ptr, (size - 1) / SLAB_SIZE_CLASS);
+}
+
+
+#endif /* SLAB_HPP_ */
@@ -0,0 +1,66 @@
+/**
+ * Per-layer trace of decision diagram construction
+ */
+
+#include <iostream>
+#include <map>
+#include <cstdlib>
+#include "trace.hpp"
+
+
+ConstructionTrace* ConstructionTrace::open(const string& filename)
+{
+	static map<string, ConstructionTrace*> traces;
+	static mutex traces_lock;
+
+	lock_guard<mutex> guard(traces_lock);
+	map<string, ConstructionTrace*>::iterator it = traces.find(filename);
+	if (it != traces.end()) {
+		return it->second;
+	}
+	ConstructionTrace* trace = new ConstructionTrace(filename);
+	traces[filename] = trace;
+	return trace;
+}
+
+
+ConstructionTrace::ConstructionTrace(const string& filename) : out(filename.c_str()), ndds(0)
+{
+	if (!out.is_open()) {
+		cout << "Error: Could not open trace file " << filename << endl;
+		exit(1);
+	}
+}
+
+
+int ConstructionTrace::start_dd()
+{
+	lock_guard<mutex> guard(lock);
+	return ndds++;
+}
+
+
+void ConstructionTrace::write_layer(int dd, bool restricted, const LayerTrace& t)
+{
+	lock_guard<mutex> guard(lock);
+	out << "{\"dd\": " << dd
+	    << ", \"restricted\": " << (restricted ? "true" : "false")
+	    << ", \"layer\": " << t.layer
+	    << ", \"var\": " << t.var
+	    << ", \"pool_size\": " << t.pool_size
+	    << ", \"before_merge\": " << t.before_merge
+	    << ", \"after_merge\": " << t.after_merge
+	    << ", \"relaxed_nodes\": " << t.relaxed_nodes
+	    << ", \"time_select\": " << t.time_select
+	    << ", \"time_merge\": " << t.time_merge
+	    << ", \"time_transitions\": " << t.time_transitions
+	    << ", \"time_probes\": " << t.time_probes
+	    << ", \"transitions\": " << t.transitions
+	    << ", \"infeasible\": " << t.infeasible
+	    << ", \"pruned\": " << t.pruned
+	    << ", \"deduplicated\": " << t.deduplicated
+	    << ", \"new_nodes\": " << t.new_nodes
+	    << ", \"state_bytes\": " << t.state_bytes
+	    << "}\n";
+	out.flush();
+}
@@ -0,0 +1,77 @@
+/**
+ * Per-layer trace of decision diagram construction
+ */
+
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <chrono>
+
+using namespace std;
+
+
+/** Statistics of the construction of one layer */
+struct LayerTrace {
+	int       layer               = 0;
+	int       var                 = -1;
+	int       pool_size           = 0;      /**< nodes left in the pool (long arcs) when the layer is taken */
+	int       before_merge        = 0;      /**< nodes in the layer before merging */
+	int       after_merge         = 0;      /**< nodes in the layer after merging */
+	int       relaxed_nodes       = 0;      /**< nodes of the layer marked as relaxed after merging */
+
+	double    time_select         = 0;      /**< seconds selecting the variable and taking the nodes of the layer from the pool */
+	double    time_merge          = 0;      /**< seconds merging (or dropping, if restricted) */
+	double    time_transitions    = 0;      /**< seconds computing children (transitions, node data and pruning) */
+	double    time_probes         = 0;      /**< seconds finding and inserting children in the pool */
+
+	long      transitions         = 0;      /**< transitions attempted (two per node) */
+	long      infeasible          = 0;      /**< transitions without a child, not counting pruned ones */
+	long      pruned              = 0;      /**< children pruned by the primal bound */
+	long      deduplicated        = 0;      /**< children absorbed into an existing node with an equivalent state */
+	long      new_nodes           = 0;      /**< children added to the pool as new nodes */
+
+	size_t    state_bytes         = 0;      /**< bytes held by states in the pool and the DD after the layer is expanded */
+};
+
+
+/**
+ * JSON Lines file with one object per layer of each DD constructed. Traces are shared by all solvers writing to the same
+ * file, and each DD gets a sequence number.
+ */
+class ConstructionTrace
+{
+public:
+
+	/** Return the trace writing to the given file, truncating the file the first time it is opened */
+	static ConstructionTrace* open(const string& filename);
+
+	/** Return the sequence number of a new DD */
+	int start_dd();
+
+	/** Write a layer of the given DD */
+	void write_layer(int dd, bool restricted, const LayerTrace& layer_trace);
+
+private:
+
+	ofstream      out;
+	mutex         lock;
+	int           ndds;
+
+	ConstructionTrace(const string& filename);
+};
+
+
+/** Seconds elapsed since the given time point, which is then reset to the current time */
+inline double trace_lap(chrono::steady_clock::time_point& start)
+{
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	double elapsed = chrono::duration<double>(now - start).count();
+	start = now;
+	return elapsed;
+}
+
+
+#endif /* TRACE_HPP_ */